@@ -3,28 +3,45 @@ out vec4 frag_color;
   
 in vec3 frag_pos;
 in vec3 normal;
+in vec3 color;
 
-uniform vec3 light_pos;
-uniform vec3 view_pos;
-uniform vec3 light_color;
-uniform vec3 object_color;
+layout (std140) uniform frame_data
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 view_pos;
+    vec4 light_pos[8];
+    vec4 light_color[8];
+    ivec4 light_count;
+} frame;
 
 void main()
 {
     float ambient_strength = 0.1;
-    vec3 ambient = ambient_strength * light_color;
+    float specular_strength = 0.5;
 
     vec3 norm = normalize(normal);
-    vec3 light_dir = normalize(light_pos - frag_pos);
-    float diff = max(dot(norm, light_dir), 0.0);
-    vec3 diffuse = diff * light_color;
+    vec3 view_dir = normalize(frame.view_pos.xyz - frag_pos);
 
-    float specular_strength = 0.5;
-    vec3 view_dir = normalize(view_pos - frag_pos);
-    vec3 reflect_dir = reflect(-light_dir, norm);
-    float spec = pow(max(dot(view_dir, reflect_dir), 0.0), 32);
-    vec3 specular = specular_strength * spec * light_color;
-
-    vec3 result = (ambient + diffuse + specular) * object_color;
-    frag_color = vec4(result, 1.0);
-}
\ No newline at end of file
+    vec3 result = vec3(0.0);
+
+    for (int i = 0; i < frame.light_count.x; i++)
+    {
+        vec3 light_color = frame.light_color[i].rgb;
+
+        vec3 ambient = ambient_strength * light_color;
+
+        vec3 light_dir = normalize(frame.light_pos[i].xyz - frag_pos);
+        float diff = max(dot(norm, light_dir), 0.0);
+        vec3 diffuse = diff * light_color;
+
+        vec3 reflect_dir = reflect(-light_dir, norm);
+        float spec = pow(max(dot(view_dir, reflect_dir), 0.0), 32);
+        vec3 specular = specular_strength * spec * light_color;
+
+        result += ambient + diffuse + specular;
+    }
+
+    frag_color = vec4(result * color, 1.0);
+}
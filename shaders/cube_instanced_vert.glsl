@@ -0,0 +1,34 @@
+#version 330 core
+layout (location = 0) in vec3 a_pos;
+layout (location = 1) in vec3 a_normal;
+
+// per-instance attributes
+layout (location = 2) in vec4 i_pos_scale;
+layout (location = 3) in vec3 i_color;
+
+out vec3 frag_pos;
+out vec3 normal;
+out vec3 color;
+
+layout (std140) uniform frame_data
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 view_pos;
+    vec4 light_pos[8];
+    vec4 light_color[8];
+    ivec4 light_count;
+} frame;
+
+void main()
+{
+    // same transform as scale(scale) * translate(pos), without a per-instance matrix
+    frag_pos = (a_pos + i_pos_scale.xyz) * i_pos_scale.w;
+
+    // uniform scale keeps normals perpendicular, so no normal matrix is needed
+    normal = a_normal;
+    color = i_color;
+
+    gl_Position = frame.view_projection * vec4(frag_pos, 1.0);
+}
@@ -1,11 +1,20 @@
 #version 330 core
 layout (location = 0) in vec3 a_pos;
 
+layout (std140) uniform frame_data
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 view_pos;
+    vec4 light_pos[8];
+    vec4 light_color[8];
+    ivec4 light_count;
+} frame;
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(a_pos, 1.0);
-}
\ No newline at end of file
+    gl_Position = frame.view_projection * model * vec4(a_pos, 1.0);
+}
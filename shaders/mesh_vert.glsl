@@ -0,0 +1,34 @@
+#version 330 core
+layout (location = 0) in vec3 a_pos;
+layout (location = 1) in vec3 a_normal;
+
+out vec3 frag_pos;
+out vec3 normal;
+out vec3 color;
+
+layout (std140) uniform frame_data
+{
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 view_pos;
+    vec4 light_pos[8];
+    vec4 light_color[8];
+    ivec4 light_count;
+} frame;
+
+uniform mat4 model;
+
+// computed once per object on the cpu, replaces transpose(inverse(model)) per vertex
+uniform mat3 normal_matrix;
+
+uniform vec3 object_color;
+
+void main()
+{
+    frag_pos = vec3(model * vec4(a_pos, 1.0));
+    normal = normal_matrix * a_normal;
+    color = object_color;
+
+    gl_Position = frame.view_projection * vec4(frag_pos, 1.0);
+}
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include <execinfo.h>
+#include <unistd.h>
+
+#include "alloc_tracker.hpp"
+
+static_assert(std::is_trivially_destructible_v<alloc_tracker>, "the per-thread tracker must not need cleanup at thread exit");
+
+alloc_tracker &alloc_tracker::get()
+{
+    // constant initialized, so the first use on a thread doesn't allocate
+    thread_local alloc_tracker tracker{};
+    return tracker;
+}
+
+const char *alloc_tracker::set_subsystem(const char *name)
+{
+    const char *previous{subsystem};
+    subsystem = name;
+    return previous;
+}
+
+std::size_t alloc_tracker::subsystem_slot()
+{
+    const std::size_t untagged{ALLOC_TRACKER_SUBSYSTEMS - 1};
+
+    if (subsystem == nullptr)
+        return untagged;
+
+    for (std::size_t i = 0; i < subsystem_count; i++)
+    {
+        if (subsystem_names[i] == subsystem)
+            return i;
+    }
+
+    if (subsystem_count == untagged)
+        return untagged;
+
+    subsystem_names[subsystem_count] = subsystem;
+    return subsystem_count++;
+}
+
+void alloc_tracker::on_allocate(std::size_t size)
+{
+    frame.allocations++;
+    frame.bytes += size;
+
+    subsystem_allocations[subsystem_slot()]++;
+
+    if (forbidden && !reporting)
+        report_violation(size);
+}
+
+void alloc_tracker::on_free()
+{
+    frame.frees++;
+}
+
+void alloc_tracker::report_violation(std::size_t size)
+{
+    reporting = true;
+    violations++;
+
+    // written straight to stderr, streams could allocate
+    std::fprintf(stderr, "ERROR::ALLOC_TRACKER::ALLOCATION_IN_NO_ALLOC_SCOPE: %zu bytes in %s\n", size, subsystem ? subsystem : "untagged");
+
+    if (capture_stacks)
+    {
+        void *stack[ALLOC_TRACKER_STACK_DEPTH];
+        int depth{backtrace(stack, ALLOC_TRACKER_STACK_DEPTH)};
+
+        // skips this function and on_allocate, the fd variant doesn't allocate
+        if (depth > 2)
+            backtrace_symbols_fd(stack + 2, depth - 2, STDERR_FILENO);
+    }
+
+    reporting = false;
+}
+
+void alloc_tracker::end_frame()
+{
+    total.allocations += frame.allocations;
+    total.frees += frame.frees;
+    total.bytes += frame.bytes;
+
+    frame = alloc_counts{};
+
+    std::memset(subsystem_allocations, 0, sizeof(subsystem_allocations));
+}
+
+std::string alloc_tracker::frame_summary() const
+{
+    // copied first, the summary's own allocations land in the frame being described
+    alloc_counts counts{frame};
+    std::uint64_t by_subsystem[ALLOC_TRACKER_SUBSYSTEMS]{};
+    std::memcpy(by_subsystem, subsystem_allocations, sizeof(by_subsystem));
+
+    std::string summary{std::to_string(counts.allocations) + " allocations (" + std::to_string(counts.bytes / 1024) + " KB)"};
+
+    const char *separator{": "};
+    for (std::size_t i = 0; i < ALLOC_TRACKER_SUBSYSTEMS; i++)
+    {
+        if (by_subsystem[i] == 0)
+            continue;
+
+        const char *name{i < subsystem_count ? subsystem_names[i] : "untagged"};
+        summary += separator + std::string(name) + " " + std::to_string(by_subsystem[i]);
+        separator = ", ";
+    }
+
+    return summary;
+}
+
+#ifdef OXIDIZER_ALLOC_TRACK
+
+// every replaceable form of operator new and delete, forwarding to malloc and free
+
+static void *tracked_allocate(std::size_t size, std::size_t alignment, bool nothrow)
+{
+    void *memory{nullptr};
+
+    if (alignment <= alignof(std::max_align_t))
+        memory = std::malloc(size ? size : 1);
+    else if (posix_memalign(&memory, alignment, size ? size : 1) != 0)
+        memory = nullptr;
+
+    if (memory == nullptr)
+    {
+        if (nothrow)
+            return nullptr;
+
+        throw std::bad_alloc{};
+    }
+
+    alloc_tracker::get().on_allocate(size);
+
+    return memory;
+}
+
+static void tracked_free(void *memory)
+{
+    if (memory == nullptr)
+        return;
+
+    alloc_tracker::get().on_free();
+    std::free(memory);
+}
+
+void *operator new(std::size_t size) {return tracked_allocate(size, 0, false);}
+void *operator new[](std::size_t size) {return tracked_allocate(size, 0, false);}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {return tracked_allocate(size, 0, true);}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {return tracked_allocate(size, 0, true);}
+void *operator new(std::size_t size, std::align_val_t alignment) {return tracked_allocate(size, (std::size_t)alignment, false);}
+void *operator new[](std::size_t size, std::align_val_t alignment) {return tracked_allocate(size, (std::size_t)alignment, false);}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {return tracked_allocate(size, (std::size_t)alignment, true);}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {return tracked_allocate(size, (std::size_t)alignment, true);}
+
+void operator delete(void *memory) noexcept {tracked_free(memory);}
+void operator delete[](void *memory) noexcept {tracked_free(memory);}
+void operator delete(void *memory, std::size_t) noexcept {tracked_free(memory);}
+void operator delete[](void *memory, std::size_t) noexcept {tracked_free(memory);}
+void operator delete(void *memory, const std::nothrow_t &) noexcept {tracked_free(memory);}
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {tracked_free(memory);}
+void operator delete(void *memory, std::align_val_t) noexcept {tracked_free(memory);}
+void operator delete[](void *memory, std::align_val_t) noexcept {tracked_free(memory);}
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {tracked_free(memory);}
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {tracked_free(memory);}
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {tracked_free(memory);}
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {tracked_free(memory);}
+
+#endif //OXIDIZER_ALLOC_TRACK
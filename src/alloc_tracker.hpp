@@ -0,0 +1,116 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+// subsystems each thread can tell apart, allocations past the last one count as untagged
+#define ALLOC_TRACKER_SUBSYSTEMS 32
+
+// return addresses kept for each reported allocation
+#define ALLOC_TRACKER_STACK_DEPTH 16
+
+// heap allocations made through operator new
+struct alloc_counts
+{
+    std::uint64_t allocations{};
+    std::uint64_t frees{};
+    std::uint64_t bytes{};
+};
+
+// counts the calling thread's heap allocations per frame and per subsystem, by replacing the global
+// operator new and delete. only built in with OXIDIZER_ALLOC_TRACK, otherwise every count stays zero.
+// use it through the ALLOC_ macros, which compile to nothing without it
+class alloc_tracker
+{
+public:
+    // the calling thread's tracker
+    static alloc_tracker &get();
+
+    // whether operator new is replaced in this build
+    static constexpr bool enabled()
+    {
+#ifdef OXIDIZER_ALLOC_TRACK
+        return true;
+#else
+        return false;
+#endif
+    };
+
+    // called from operator new and delete, these must never allocate
+    void on_allocate(std::size_t size);
+    void on_free();
+
+    // to fold this frame's counts into the totals and start counting the next frame
+    void end_frame();
+
+    const alloc_counts &get_frame() const {return frame;};
+    const alloc_counts &get_total() const {return total;};
+
+    // to summarize this frame, like "12 allocations (3 KB): render_queue 10, untagged 2"
+    std::string frame_summary() const;
+
+    // to report every allocation on this thread as a violation, for hot paths that must not allocate
+    void set_forbidden(bool a_forbidden) {forbidden = a_forbidden;};
+    std::uint64_t get_violations() const {return violations;};
+
+    // to print the callstack of every violation
+    void set_capture_stacks(bool a_capture) {capture_stacks = a_capture;};
+
+    // to attribute allocations to a subsystem, names must be string literals
+    const char *set_subsystem(const char *name);
+
+private:
+    // to find or add the current subsystem's slot, the last slot collects the overflow and untagged work
+    std::size_t subsystem_slot();
+
+    void report_violation(std::size_t size);
+
+    alloc_counts frame{};
+    alloc_counts total{};
+
+    const char *subsystem{nullptr};
+
+    // this frame's allocations by subsystem
+    const char *subsystem_names[ALLOC_TRACKER_SUBSYSTEMS]{};
+    std::uint64_t subsystem_allocations[ALLOC_TRACKER_SUBSYSTEMS]{};
+    std::size_t subsystem_count{0};
+
+    bool forbidden{false};
+    bool capture_stacks{false};
+    std::uint64_t violations{0};
+
+    // set while the tracker itself runs, so allocations made by reporting aren't reported
+    bool reporting{false};
+};
+
+// attributes the calling thread's allocations to a subsystem until the end of the scope
+class alloc_subsystem_scope
+{
+public:
+    explicit alloc_subsystem_scope(const char *name) : previous(alloc_tracker::get().set_subsystem(name)) {};
+    ~alloc_subsystem_scope() {alloc_tracker::get().set_subsystem(previous);};
+
+    alloc_subsystem_scope(const alloc_subsystem_scope &) = delete;
+    alloc_subsystem_scope &operator=(const alloc_subsystem_scope &) = delete;
+
+private:
+    const char *previous;
+};
+
+#ifdef OXIDIZER_ALLOC_TRACK
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+
+// to attribute the rest of the enclosing scope's allocations to a subsystem
+#define ALLOC_SCOPE(name) alloc_subsystem_scope ALLOC_CONCAT(alloc_scope_, __LINE__){name}
+
+#else
+
+#define ALLOC_SCOPE(name)
+
+#endif //OXIDIZER_ALLOC_TRACK
+
+#endif //ALLOC_TRACKER_H
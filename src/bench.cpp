@@ -0,0 +1,526 @@
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "render_stats.hpp"
+#include "profiler.hpp"
+#include "gl_trace.hpp"
+#include "alloc_tracker.hpp"
+#include "gl_handle.hpp"
+#include "renderer.hpp"
+#include "scenes.hpp"
+#include "frame_stats.hpp"
+#include "frustum_cull.hpp"
+#include "window.hpp"
+
+#define RENDER_WIDTH 320
+#define RENDER_HEIGHT 180
+
+// largest difference allowed per 8-bit channel between the packed and float layouts. colors quantized
+// to 8 bits are within half a step of the float ones, lighting and writing the result can add one more
+#define LAYOUT_TOLERANCE 2
+
+// command line options, the full suite runs unless --scene is given
+struct bench_options
+{
+    bool single{false};
+    scene_desc scene{};
+    int frames{120};
+    int warmup{10};
+    std::string output{"bench.json"};
+
+    // fail if a measured frame allocates, warm-up frames may
+    bool no_alloc{false};
+
+    // cull by testing every cube instead of walking the bvh
+    bool flat_cull{false};
+
+    // draw cubes the occlusion buffer would have dropped
+    bool no_occlusion{false};
+
+    // hardware occlusion queries for mesh objects and light gizmos
+    occlusion_query_mode queries{occlusion_query_mode::off};
+
+    // compare the first frame of every scene drawn with packed and with float layouts instead of timing
+    bool check_layouts{false};
+
+    // invert the model matrix per vertex in the mesh shader instead of using the cpu normal matrix
+    bool vertex_normal_matrix{false};
+
+    // redraw every scene from a still camera and fail on any allocation or copy instead of timing
+    bool check_steady{false};
+};
+
+// what one scenario measured, frame times in milliseconds and counters averaged per frame
+struct bench_result
+{
+    scene_desc scene{};
+    int frames{};
+
+    // submit time on the cpu, time until the frame finished, and GL_TIME_ELAPSED on the gpu
+    std::vector<double> cpu_ms{};
+    std::vector<double> frame_ms{};
+    std::vector<double> gpu_ms{};
+
+    render_stats totals{};
+
+    // operator new calls over the measured frames, zero without OXIDIZER_ALLOC_TRACK
+    std::uint64_t allocations{};
+
+    long peak_rss_kb{};
+
+    // the most any frame took from the frame arena so far
+    std::size_t arena_high_water{};
+};
+
+// to parse --scene NAME --count N --lights N --frames N --warmup N --output path.json
+bool parse_options(int argc, char **argv, bench_options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg{argv[i]};
+        bool has_value{i + 1 < argc};
+
+        if (arg == "--scene" && has_value && parse_scene(argv[i + 1], opts.scene.kind))
+        {
+            opts.single = true;
+            i++;
+        }
+        else if (arg == "--count" && has_value)
+            opts.scene.objects = std::atoi(argv[++i]);
+        else if (arg == "--lights" && has_value)
+            opts.scene.lights = std::atoi(argv[++i]);
+        else if (arg == "--frames" && has_value)
+            opts.frames = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && has_value)
+            opts.warmup = std::atoi(argv[++i]);
+        else if (arg == "--output" && has_value)
+            opts.output = argv[++i];
+        else if (arg == "--assert-no-alloc")
+            opts.no_alloc = true;
+        else if (arg == "--flat-cull")
+            opts.flat_cull = true;
+        else if (arg == "--no-occlusion")
+            opts.no_occlusion = true;
+        else if (arg == "--check-layouts")
+            opts.check_layouts = true;
+        else if (arg == "--normal-matrix" && has_value && (std::string{argv[i + 1]} == "cpu" || std::string{argv[i + 1]} == "vertex"))
+            opts.vertex_normal_matrix = std::string{argv[++i]} == "vertex";
+        else if (arg == "--check-steady")
+            opts.check_steady = true;
+        else if (arg == "--occlusion-queries" && has_value && parse_occlusion_query_mode(argv[i + 1], opts.queries))
+            i++;
+        else
+        {
+            std::cout << "usage: bench [--scene scatter|grid|terrain|moving] [--count N] [--lights N] "
+                         "[--frames N] [--warmup N] [--output bench.json] [--assert-no-alloc] [--flat-cull] [--no-occlusion] "
+                         "[--occlusion-queries off|conditional|latent] [--normal-matrix cpu|vertex] [--check-layouts] [--check-steady]" << std::endl;
+            return false;
+        }
+    }
+
+    opts.scene.objects = std::max(opts.scene.objects, 0);
+    opts.scene.lights = std::max(opts.scene.lights, 0);
+    opts.frames = std::max(opts.frames, 1);
+    opts.warmup = std::max(opts.warmup, 0);
+
+    return true;
+}
+
+// every scene at 1k to 1M objects with one light and with a full set, moving scenes stop at 10k
+// since each object is its own draw. ordered by size so peak RSS grows with the scenarios
+std::vector<scene_desc> default_suite()
+{
+    std::vector<scene_desc> suite{};
+
+    for (int objects : {1000, 10000, 100000, 1000000})
+    {
+        for (scene_kind kind : {scene_kind::scatter, scene_kind::grid, scene_kind::terrain, scene_kind::moving})
+        {
+            if (kind == scene_kind::moving && objects > 10000)
+                continue;
+
+            for (int lights : {1, MAX_LIGHTS})
+                suite.push_back(scene_desc{kind, objects, lights});
+        }
+    }
+
+    return suite;
+}
+
+// to read the process' peak resident set size so far
+long peak_rss_kb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    // bytes on macOS, kilobytes on Linux
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+bench_result run_scenario(renderer &a_renderer, const scene_desc &scene, int frames, int warmup, bool no_alloc)
+{
+    bench_result result{scene, frames};
+
+    build_scene(a_renderer, scene);
+
+    std::vector<query> gpu_queries{};
+    for (int i = 0; i < frames; i++)
+        gpu_queries.push_back(query::create());
+
+    result.cpu_ms.resize(frames);
+    result.frame_ms.resize(frames);
+
+    for (int frame = -warmup; frame < frames; frame++)
+    {
+        g_render_stats.reset();
+        alloc_tracker::get().end_frame();
+
+        auto start = std::chrono::steady_clock::now();
+
+        alloc_tracker::get().set_forbidden(no_alloc && frame >= 0);
+
+        animate_scene(a_renderer, scene, frame);
+        a_renderer.get_camera().orbit((float)frame, 3.0f);
+
+        if (frame >= 0)
+            glBeginQuery(GL_TIME_ELAPSED, gpu_queries[frame].get());
+
+        a_renderer.render();
+
+        if (frame >= 0)
+            glEndQuery(GL_TIME_ELAPSED);
+
+        alloc_tracker::get().set_forbidden(false);
+
+        auto submitted = std::chrono::steady_clock::now();
+
+        // wait for the gpu, so a frame's time covers all of its work and frames don't overlap
+        {
+            PROFILE_SCOPE("glFinish");
+            glFinish();
+        }
+
+        profile_render_stats();
+        PROFILE_FRAME();
+        gl_trace::get().end_frame();
+
+        auto finished = std::chrono::steady_clock::now();
+
+        if (frame < 0)
+            continue;
+
+        result.cpu_ms[frame] = std::chrono::duration<double, std::milli>(submitted - start).count();
+        result.frame_ms[frame] = std::chrono::duration<double, std::milli>(finished - start).count();
+
+        result.allocations += alloc_tracker::get().get_frame().allocations;
+
+        result.totals.uniform_bytes += g_render_stats.uniform_bytes;
+        result.totals.uniform_calls_skipped += g_render_stats.uniform_calls_skipped;
+        result.totals.draw_calls += g_render_stats.draw_calls;
+        result.totals.program_binds += g_render_stats.program_binds;
+        result.totals.vao_binds += g_render_stats.vao_binds;
+        result.totals.state_calls_issued += g_render_stats.state_calls_issued;
+        result.totals.state_calls_skipped += g_render_stats.state_calls_skipped;
+        result.totals.instances_culled += g_render_stats.instances_culled;
+        result.totals.instances_occluded += g_render_stats.instances_occluded;
+        result.totals.instances_copied += g_render_stats.instances_copied;
+        result.totals.occlusion_queries += g_render_stats.occlusion_queries;
+        result.totals.draws_skipped += g_render_stats.draws_skipped;
+        result.totals.occluded_results += g_render_stats.occluded_results;
+    }
+
+    for (query &gpu_query : gpu_queries)
+    {
+        GLuint64 elapsed{};
+        glGetQueryObjectui64v(gpu_query.get(), GL_QUERY_RESULT, &elapsed);
+        result.gpu_ms.push_back(elapsed / 1.0e6);
+    }
+
+    result.peak_rss_kb = peak_rss_kb();
+    result.arena_high_water = a_renderer.get_arena().get_high_water();
+
+    return result;
+}
+
+// to write the nearest-rank percentiles of a series of frame times
+void write_percentiles(std::ofstream &file, std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    double sum{0.0};
+    for (double sample : samples)
+        sum += sample;
+
+    file << "{\"mean\": " << sum / samples.size()
+         << ", \"p50\": " << percentile(samples, 50.0)
+         << ", \"p90\": " << percentile(samples, 90.0)
+         << ", \"p99\": " << percentile(samples, 99.0)
+         << ", \"max\": " << samples.back() << "}";
+}
+
+// to draw a scene's first frame with packed or float layouts and read it back
+void render_layout(const scene_desc &scene, bool packed, std::vector<std::uint8_t> &rgb)
+{
+    // one renderer at a time, each binds its own per-frame uniform block
+    renderer a_renderer{RENDER_WIDTH, RENDER_HEIGHT, packed};
+
+    build_scene(a_renderer, scene);
+    a_renderer.get_camera().orbit(0.0f, 3.0f);
+    a_renderer.render();
+    a_renderer.read_pixels(rgb);
+}
+
+// to compare every scene drawn with packed layouts against the float ones, returns whether all are within LAYOUT_TOLERANCE
+bool check_layouts(const std::vector<scene_desc> &suite)
+{
+    bool passed{true};
+
+    std::vector<std::uint8_t> packed{};
+    std::vector<std::uint8_t> full{};
+
+    for (const scene_desc &scene : suite)
+    {
+        render_layout(scene, true, packed);
+        render_layout(scene, false, full);
+
+        int max_difference{0};
+        std::size_t over{0};
+
+        for (std::size_t i = 0; i < packed.size(); i++)
+        {
+            int difference{std::abs((int)packed[i] - (int)full[i])};
+
+            max_difference = std::max(max_difference, difference);
+            if (difference > LAYOUT_TOLERANCE)
+                over++;
+        }
+
+        std::cout << scene_name(scene.kind) << " objects: " << scene.objects << " lights: " << scene.lights
+                  << " largest channel difference: " << max_difference << std::endl;
+
+        if (over)
+        {
+            std::cout << "ERROR::BENCH::LAYOUT_MISMATCH: " << over << " channels differ by more than " << LAYOUT_TOLERANCE << std::endl;
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+// to redraw every scene in full from a still camera, returns whether no measured frame allocated,
+// copied cube records or uploaded geometry. the static layer is marked dirty every frame so culling,
+// submitting and flushing all run, but nothing they draw changes
+bool check_steady(renderer &a_renderer, const std::vector<scene_desc> &suite, int frames, int warmup)
+{
+    bool passed{true};
+
+    for (const scene_desc &scene : suite)
+    {
+        build_scene(a_renderer, scene);
+        a_renderer.get_camera().orbit(0.0f, 3.0f);
+
+        std::uint64_t allocations{0};
+        std::uint64_t instances_copied{0};
+        std::uint64_t meshes_uploaded{0};
+
+        for (int frame = -warmup; frame < frames; frame++)
+        {
+            g_render_stats.reset();
+            alloc_tracker::get().end_frame();
+
+            alloc_tracker::get().set_forbidden(frame >= 0);
+
+            a_renderer.mark_dirty();
+            a_renderer.render();
+
+            alloc_tracker::get().set_forbidden(false);
+
+            glFinish();
+
+            if (frame < 0)
+                continue;
+
+            allocations += alloc_tracker::get().get_frame().allocations;
+            instances_copied += g_render_stats.instances_copied;
+            meshes_uploaded += g_render_stats.meshes_uploaded;
+        }
+
+        std::cout << scene_name(scene.kind) << " objects: " << scene.objects << " lights: " << scene.lights
+                  << " allocations: " << allocations << " instances copied: " << instances_copied
+                  << " meshes uploaded: " << meshes_uploaded << std::endl;
+
+        if (allocations || instances_copied || meshes_uploaded)
+        {
+            std::cout << "ERROR::BENCH::STEADY_STATE_COPIES: " << scene_name(scene.kind) << " copied or allocated after warm-up" << std::endl;
+            passed = false;
+        }
+    }
+
+    a_renderer.clear_scene();
+
+    return passed;
+}
+
+bool write_results(const std::string &path, const std::vector<bench_result> &results, const bench_options &opts)
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cout << "ERROR::BENCH::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"width\": " << RENDER_WIDTH << ",\n";
+    file << "  \"height\": " << RENDER_HEIGHT << ",\n";
+    file << "  \"renderer\": \"" << (const char *)glGetString(GL_RENDERER) << "\",\n";
+    file << "  \"culling\": \"" << (opts.flat_cull ? "flat" : "bvh") << "\",\n";
+    file << "  \"occlusion\": " << (opts.no_occlusion ? "false" : "true") << ",\n";
+    file << "  \"occlusion_queries\": \"" << occlusion_query_mode_name(opts.queries) << "\",\n";
+    file << "  \"normal_matrix\": \"" << (opts.vertex_normal_matrix ? "vertex" : "cpu") << "\",\n";
+    file << "  \"cull_kernel\": \"" << cull_kernel_name(get_cull_kernel()) << "\",\n";
+    file << "  \"results\": [\n";
+
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const bench_result &result{results[i]};
+        double frames{(double)result.frames};
+
+        file << "    {\n";
+        file << "      \"scene\": \"" << scene_name(result.scene.kind) << "\",\n";
+        file << "      \"objects\": " << result.scene.objects << ",\n";
+        file << "      \"lights\": " << result.scene.lights << ",\n";
+        file << "      \"frames\": " << result.frames << ",\n";
+        file << "      \"cpu_ms\": "; write_percentiles(file, result.cpu_ms); file << ",\n";
+        file << "      \"frame_ms\": "; write_percentiles(file, result.frame_ms); file << ",\n";
+        file << "      \"gpu_ms\": "; write_percentiles(file, result.gpu_ms); file << ",\n";
+        file << "      \"draw_calls\": " << result.totals.draw_calls / frames << ",\n";
+        file << "      \"program_binds\": " << result.totals.program_binds / frames << ",\n";
+        file << "      \"vao_binds\": " << result.totals.vao_binds / frames << ",\n";
+        file << "      \"state_calls_issued\": " << result.totals.state_calls_issued / frames << ",\n";
+        file << "      \"state_calls_skipped\": " << result.totals.state_calls_skipped / frames << ",\n";
+        file << "      \"uniform_bytes\": " << result.totals.uniform_bytes / frames << ",\n";
+        file << "      \"uniform_calls_skipped\": " << result.totals.uniform_calls_skipped / frames << ",\n";
+        file << "      \"instances_culled\": " << result.totals.instances_culled / frames << ",\n";
+        file << "      \"instances_occluded\": " << result.totals.instances_occluded / frames << ",\n";
+        file << "      \"instances_copied\": " << result.totals.instances_copied / frames << ",\n";
+        file << "      \"occlusion_queries\": " << result.totals.occlusion_queries / frames << ",\n";
+        file << "      \"draws_skipped\": " << result.totals.draws_skipped / frames << ",\n";
+        file << "      \"occluded_results\": " << result.totals.occluded_results / frames << ",\n";
+        file << "      \"allocations\": " << result.allocations / frames << ",\n";
+        file << "      \"arena_high_water_bytes\": " << result.arena_high_water << ",\n";
+        file << "      \"peak_rss_kb\": " << result.peak_rss_kb << "\n";
+        file << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    file << "  ]\n";
+    file << "}\n";
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bench_options opts{};
+    if (!parse_options(argc, argv, opts))
+        return -1;
+
+    GLFWwindow *window = open_window(RENDER_WIDTH, RENDER_HEIGHT, true);
+    if (window == NULL)
+        return -1;
+
+    bool written{false};
+
+    if (opts.check_layouts)
+    {
+        bool passed{check_layouts(opts.single ? std::vector<scene_desc>{opts.scene} : default_suite())};
+
+        glfwTerminate();
+        return passed ? 0 : -1;
+    }
+
+    if (opts.check_steady)
+    {
+        bool passed{false};
+
+        // the renderer goes before the context does
+        {
+            renderer a_renderer{RENDER_WIDTH, RENDER_HEIGHT};
+            a_renderer.get_cubes().set_tree_culling(!opts.flat_cull);
+            a_renderer.set_occlusion_culling(!opts.no_occlusion);
+
+            passed = check_steady(a_renderer, opts.single ? std::vector<scene_desc>{opts.scene} : default_suite(), opts.frames, opts.warmup);
+        }
+
+        glfwTerminate();
+
+        if (!alloc_tracker::enabled())
+            std::cout << "--check-steady needs a build with OXIDIZER_ALLOC_TRACK to count allocations, only copies were checked" << std::endl;
+
+        return passed ? 0 : -1;
+    }
+
+    // every GL object below is owned by a handle, this scope ends before the context is destroyed
+    {
+        renderer a_renderer{RENDER_WIDTH, RENDER_HEIGHT};
+        a_renderer.get_cubes().set_tree_culling(!opts.flat_cull);
+        a_renderer.set_occlusion_culling(!opts.no_occlusion);
+        a_renderer.set_occlusion_queries(opts.queries);
+        a_renderer.set_vertex_normal_matrix(opts.vertex_normal_matrix);
+
+        std::vector<scene_desc> suite{opts.single ? std::vector<scene_desc>{opts.scene} : default_suite()};
+        std::vector<bench_result> results{};
+
+        for (const scene_desc &scene : suite)
+        {
+            std::cout << scene_name(scene.kind) << " objects: " << scene.objects << " lights: " << scene.lights << "..." << std::flush;
+
+            results.push_back(run_scenario(a_renderer, scene, opts.frames, opts.warmup, opts.no_alloc));
+
+            std::vector<double> sorted{results.back().frame_ms};
+            std::sort(sorted.begin(), sorted.end());
+            std::cout << " median frame " << sorted[sorted.size() / 2] << " ms" << std::endl;
+        }
+
+        a_renderer.clear_scene();
+
+        // the trace covers the tail of the last scenario
+        PROFILE_DUMP("bench_trace.json");
+
+        // traced calls are slower, so a traced run is for call counts and not for timings
+        if (gl_trace::get().is_installed())
+            gl_trace::get().write_csv("bench_gl_calls.csv");
+
+        written = write_results(opts.output, results, opts);
+        if (written)
+            std::cout << "wrote " << opts.output << std::endl;
+    }
+
+    glfwTerminate();
+
+    if (opts.no_alloc && !alloc_tracker::enabled())
+        std::cout << "--assert-no-alloc needs a build with OXIDIZER_ALLOC_TRACK, allocations weren't checked" << std::endl;
+
+    if (alloc_tracker::get().get_violations() != 0)
+    {
+        std::cout << "ERROR::ALLOC_TRACKER::STEADY_STATE_ALLOCATIONS: " << alloc_tracker::get().get_violations() << " allocations in measured frames" << std::endl;
+        return -1;
+    }
+
+    return written ? 0 : -1;
+}
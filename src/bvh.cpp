@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <cmath>
+
+#include "bvh.hpp"
+#include "profiler.hpp"
+
+float aabb::raycast(const glm::vec3 &origin, const glm::vec3 &inv_dir, float max_t) const
+{
+    // slab test, an axis the ray runs parallel to gives infinities that compare correctly
+    glm::vec3 t0{(min - origin) * inv_dir};
+    glm::vec3 t1{(max - origin) * inv_dir};
+
+    glm::vec3 t_near{glm::min(t0, t1)};
+    glm::vec3 t_far{glm::max(t0, t1)};
+
+    float enter{std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f))};
+    float exit{std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_t))};
+
+    return enter <= exit ? enter : -1.0f;
+}
+
+int bvh::allocate_node()
+{
+    if (free_list == BVH_NULL)
+    {
+        nodes.emplace_back();
+        return (int)nodes.size() - 1;
+    }
+
+    int index{free_list};
+    free_list = nodes[index].left;
+    nodes[index] = bvh_node{};
+
+    return index;
+}
+
+void bvh::free_node(int index)
+{
+    nodes[index] = bvh_node{};
+    nodes[index].left = free_list;
+    free_list = index;
+}
+
+aabb bvh::fatten(const aabb &box) const
+{
+    glm::vec3 extent{box.extent()};
+    glm::vec3 pad{margin * std::max(std::max(extent.x, extent.y), extent.z)};
+
+    return aabb{box.min - pad, box.max + pad};
+}
+
+int bvh::insert(const aabb &box, std::uint32_t user)
+{
+    int leaf{allocate_node()};
+
+    nodes[leaf].box = fatten(box);
+    nodes[leaf].user = user;
+    nodes[leaf].built_area = nodes[leaf].box.area();
+
+    insert_leaf(leaf);
+    leaf_count++;
+
+    return leaf;
+}
+
+void bvh::remove(int proxy)
+{
+    remove_leaf(proxy);
+    free_node(proxy);
+    leaf_count--;
+}
+
+bool bvh::move(int proxy, const aabb &box)
+{
+    if (nodes[proxy].box.contains(box))
+        return false;
+
+    // the leaf keeps its place, a subtree the move loosens too much is rebuilt later
+    nodes[proxy].box = fatten(box);
+    refit_from(nodes[proxy].parent);
+
+    return true;
+}
+
+void bvh::clear()
+{
+    nodes.clear();
+    dirty_nodes.clear();
+
+    root = BVH_NULL;
+    free_list = BVH_NULL;
+    leaf_count = 0;
+}
+
+void bvh::insert_leaf(int leaf)
+{
+    if (root == BVH_NULL)
+    {
+        root = leaf;
+        nodes[leaf].parent = BVH_NULL;
+        return;
+    }
+
+    const aabb &leaf_box{nodes[leaf].box};
+
+    // walk down while pushing the leaf into a child is cheaper than pairing it with the whole node
+    int index{root};
+    while (!nodes[index].is_leaf())
+    {
+        const bvh_node &node{nodes[index]};
+
+        float area{node.box.area()};
+        float combined_area{merge(node.box, leaf_box).area()};
+
+        // pairing here makes a new parent with the combined area, and every ancestor grows by the difference
+        float cost{2.0f * combined_area};
+        float inheritance{2.0f * (combined_area - area)};
+
+        auto descend_cost = [&](int child)
+        {
+            const aabb &child_box{nodes[child].box};
+            float merged{merge(child_box, leaf_box).area()};
+
+            return (nodes[child].is_leaf() ? merged : merged - child_box.area()) + inheritance;
+        };
+
+        float left_cost{descend_cost(node.left)};
+        float right_cost{descend_cost(node.right)};
+
+        if (cost < left_cost && cost < right_cost)
+            break;
+
+        index = left_cost < right_cost ? node.left : node.right;
+    }
+
+    int sibling{index};
+    int old_parent{nodes[sibling].parent};
+
+    int new_parent{allocate_node()};
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].left = sibling;
+    nodes[new_parent].right = leaf;
+    nodes[new_parent].box = merge(nodes[sibling].box, nodes[leaf].box);
+    nodes[new_parent].built_area = nodes[new_parent].box.area();
+
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    if (old_parent == BVH_NULL)
+        root = new_parent;
+    else if (nodes[old_parent].left == sibling)
+        nodes[old_parent].left = new_parent;
+    else
+        nodes[old_parent].right = new_parent;
+
+    refit_from(old_parent);
+}
+
+void bvh::remove_leaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = BVH_NULL;
+        return;
+    }
+
+    // the leaf's parent goes away and its sibling takes the parent's place
+    int parent{nodes[leaf].parent};
+    int grand_parent{nodes[parent].parent};
+    int sibling{nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left};
+
+    nodes[sibling].parent = grand_parent;
+
+    if (grand_parent == BVH_NULL)
+        root = sibling;
+    else if (nodes[grand_parent].left == parent)
+        nodes[grand_parent].left = sibling;
+    else
+        nodes[grand_parent].right = sibling;
+
+    free_node(parent);
+    refit_from(grand_parent);
+}
+
+void bvh::refit_from(int index)
+{
+    while (index != BVH_NULL)
+    {
+        bvh_node &node{nodes[index]};
+        node.box = merge(nodes[node.left].box, nodes[node.right].box);
+
+        if (!node.dirty && node.box.area() > node.built_area * BVH_REBUILD_GROWTH)
+        {
+            node.dirty = true;
+            dirty_nodes.push_back(index);
+        }
+
+        index = node.parent;
+    }
+}
+
+void bvh::rebuild_dirty()
+{
+    if (dirty_nodes.empty())
+        return;
+
+    PROFILE_SCOPE("bvh::rebuild_dirty");
+
+    for (int index : dirty_nodes)
+    {
+        // already rebuilt as part of an ancestor, or freed since it was flagged
+        if (!nodes[index].dirty)
+            continue;
+
+        // only the topmost dirty node of a chain is rebuilt, it covers the rest
+        int top{index};
+        for (int ancestor = nodes[index].parent; ancestor != BVH_NULL; ancestor = nodes[ancestor].parent)
+        {
+            if (nodes[ancestor].dirty)
+                top = ancestor;
+        }
+
+        rebuild(top);
+    }
+
+    dirty_nodes.clear();
+}
+
+void bvh::rebuild(int index)
+{
+    build_leaves.clear();
+    build_inner.clear();
+
+    stack.clear();
+    stack.push_back(index);
+
+    while (!stack.empty())
+    {
+        int current{stack.back()};
+        stack.pop_back();
+
+        if (nodes[current].is_leaf())
+        {
+            build_leaves.push_back(current);
+            continue;
+        }
+
+        build_inner.push_back(current);
+        stack.push_back(nodes[current].left);
+        stack.push_back(nodes[current].right);
+    }
+
+    int parent{nodes[index].parent};
+    bool is_left{parent != BVH_NULL && nodes[parent].left == index};
+
+    int subtree{build(0, build_leaves.size())};
+    nodes[subtree].parent = parent;
+
+    if (parent == BVH_NULL)
+        root = subtree;
+    else if (is_left)
+        nodes[parent].left = subtree;
+    else
+        nodes[parent].right = subtree;
+}
+
+int bvh::build(std::size_t first, std::size_t last)
+{
+    if (last - first == 1)
+        return build_leaves[first];
+
+    aabb centroids{nodes[build_leaves[first]].box.center(), nodes[build_leaves[first]].box.center()};
+    for (std::size_t i = first + 1; i < last; i++)
+    {
+        glm::vec3 center{nodes[build_leaves[i]].box.center()};
+        centroids = merge(centroids, aabb{center, center});
+    }
+
+    glm::vec3 spread{centroids.max - centroids.min};
+    int axis{spread.x > spread.y ? (spread.x > spread.z ? 0 : 2) : (spread.y > spread.z ? 1 : 2)};
+
+    std::size_t middle{first + (last - first) / 2};
+
+    if (spread[axis] > 0.0f)
+    {
+        // bin the leaves by centroid and split where area times count is lowest on both sides
+        float scale{BVH_SAH_BINS / spread[axis]};
+        auto bin_of = [&](int leaf)
+        {
+            int bin{(int)((nodes[leaf].box.center()[axis] - centroids.min[axis]) * scale)};
+            return std::min(bin, BVH_SAH_BINS - 1);
+        };
+
+        aabb bin_boxes[BVH_SAH_BINS]{};
+        std::size_t bin_counts[BVH_SAH_BINS]{};
+
+        for (std::size_t i = first; i < last; i++)
+        {
+            int bin{bin_of(build_leaves[i])};
+            const aabb &box{nodes[build_leaves[i]].box};
+
+            bin_boxes[bin] = bin_counts[bin] ? merge(bin_boxes[bin], box) : box;
+            bin_counts[bin]++;
+        }
+
+        // sweep from the right so the cost of every split is known in one more pass from the left
+        float right_cost[BVH_SAH_BINS]{};
+        aabb right_box{};
+        std::size_t right_count{0};
+        for (int bin = BVH_SAH_BINS - 1; bin > 0; bin--)
+        {
+            if (bin_counts[bin])
+                right_box = right_count ? merge(right_box, bin_boxes[bin]) : bin_boxes[bin];
+            right_count += bin_counts[bin];
+            right_cost[bin] = right_count ? right_box.area() * right_count : 0.0f;
+        }
+
+        int best_split{0};
+        float best_cost{0.0f};
+        aabb left_box{};
+        std::size_t left_count{0};
+        for (int bin = 0; bin < BVH_SAH_BINS - 1; bin++)
+        {
+            if (bin_counts[bin])
+                left_box = left_count ? merge(left_box, bin_boxes[bin]) : bin_boxes[bin];
+            left_count += bin_counts[bin];
+
+            if (left_count == 0 || left_count == last - first)
+                continue;
+
+            float cost{left_box.area() * left_count + right_cost[bin + 1]};
+            if (best_split == 0 || cost < best_cost)
+            {
+                best_split = bin + 1;
+                best_cost = cost;
+            }
+        }
+
+        if (best_split != 0)
+        {
+            auto split = std::partition(build_leaves.begin() + first, build_leaves.begin() + last,
+                                        [&](int leaf) {return bin_of(leaf) < best_split;});
+            middle = (std::size_t)(split - build_leaves.begin());
+        }
+    }
+
+    int index{build_inner.back()};
+    build_inner.pop_back();
+
+    int left{build(first, middle)};
+    int right{build(middle, last)};
+
+    bvh_node &node{nodes[index]};
+    node.left = left;
+    node.right = right;
+    node.box = merge(nodes[left].box, nodes[right].box);
+    node.built_area = node.box.area();
+    node.dirty = false;
+
+    nodes[left].parent = index;
+    nodes[right].parent = index;
+
+    return index;
+}
+
+std::size_t bvh::cull(const frustum &view_frustum, std::uint32_t *visible) const
+{
+    PROFILE_SCOPE("bvh::cull");
+
+    std::size_t count{0};
+
+    if (root == BVH_NULL)
+        return count;
+
+    cull_stack.clear();
+    cull_stack.emplace_back(root, (std::uint8_t)0x3f);
+
+    while (!cull_stack.empty())
+    {
+        auto [index, planes] = cull_stack.back();
+        cull_stack.pop_back();
+
+        const bvh_node &node{nodes[index]};
+
+        glm::vec3 center{node.box.center()};
+        glm::vec3 extent{node.box.extent()};
+
+        bool outside{false};
+        for (int plane_index = 0; plane_index < 6 && !outside; plane_index++)
+        {
+            if (!(planes & (1 << plane_index)))
+                continue;
+
+            const glm::vec4 &plane{view_frustum.planes[plane_index]};
+            float distance{glm::dot(glm::vec3(plane), center) + plane.w};
+            float radius{glm::dot(glm::abs(glm::vec3(plane)), extent)};
+
+            if (distance + radius < 0.0f)
+                outside = true;
+            else if (distance - radius >= 0.0f)
+                planes &= (std::uint8_t)~(1 << plane_index);
+        }
+
+        if (outside)
+            continue;
+
+        if (node.is_leaf())
+        {
+            visible[count++] = node.user;
+            continue;
+        }
+
+        // children of a node inside every plane are inside too, and skip the plane tests
+        cull_stack.emplace_back(node.right, planes);
+        cull_stack.emplace_back(node.left, planes);
+    }
+
+    return count;
+}
+
+int bvh::get_height() const
+{
+    if (root == BVH_NULL)
+        return 0;
+
+    int height{0};
+
+    std::vector<std::pair<int, int>> pending{{root, 1}};
+    while (!pending.empty())
+    {
+        auto [index, depth] = pending.back();
+        pending.pop_back();
+
+        height = std::max(height, depth);
+
+        if (!nodes[index].is_leaf())
+        {
+            pending.emplace_back(nodes[index].left, depth + 1);
+            pending.emplace_back(nodes[index].right, depth + 1);
+        }
+    }
+
+    return height;
+}
+
+float bvh::get_sah_cost() const
+{
+    if (root == BVH_NULL || nodes[root].is_leaf())
+        return 0.0f;
+
+    float inner_area{0.0f};
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const bvh_node &node{nodes[stack.back()]};
+        stack.pop_back();
+
+        if (node.is_leaf())
+            continue;
+
+        inner_area += node.box.area();
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+
+    return inner_area / nodes[root].box.area();
+}
@@ -0,0 +1,214 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "frustum_cull.hpp"
+
+#ifndef BVH_H
+#define BVH_H
+
+// marks a missing parent, child or free list entry
+#define BVH_NULL -1
+
+// a subtree is rebuilt once refits grow its surface area past this factor of its area when built
+#define BVH_REBUILD_GROWTH 1.5f
+
+// centroid bins tried per split during a rebuild
+#define BVH_SAH_BINS 12
+
+struct aabb
+{
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+
+    bool contains(const aabb &other) const {return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));};
+    bool overlaps(const aabb &other) const {return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));};
+
+    glm::vec3 center() const {return (min + max) * 0.5f;};
+    glm::vec3 extent() const {return (max - min) * 0.5f;};
+
+    // half the surface area, the SAH only compares areas so the factor of two is dropped
+    float area() const {glm::vec3 size{max - min}; return size.x * size.y + size.y * size.z + size.z * size.x;};
+
+    // to get the ray's entry distance, or a negative value when it misses before max_t
+    float raycast(const glm::vec3 &origin, const glm::vec3 &inv_dir, float max_t) const;
+};
+
+inline aabb merge(const aabb &a, const aabb &b) {return aabb{glm::min(a.min, b.min), glm::max(a.max, b.max)};}
+
+// one node per cache line, leaves hold a proxy's fat box and user value, inner nodes the union of their children
+struct alignas(64) bvh_node
+{
+    aabb box{};
+
+    std::int32_t parent{BVH_NULL};
+
+    // BVH_NULL for a leaf, left doubles as the next free node once the node is freed
+    std::int32_t left{BVH_NULL};
+    std::int32_t right{BVH_NULL};
+
+    std::uint32_t user{};
+
+    // surface area when the node was last built, refits compare against it
+    float built_area{};
+
+    bool dirty{false};
+
+    bool is_leaf() const {return right == BVH_NULL;};
+};
+
+static_assert(sizeof(bvh_node) == 64, "bvh nodes must stay one cache line");
+
+// a dynamic AABB tree in one flat node array. proxies keep their index for their whole life,
+// moves inside the fat box are free, moves outside refit the ancestors in place and
+// subtrees that refits loosened too much are rebuilt with a binned SAH in rebuild_dirty.
+// queries reuse one traversal stack, so they aren't reentrant or thread safe
+class bvh
+{
+public:
+    // leaves are fattened by margin times their largest half extent, so small moves don't touch the tree
+    explicit bvh(float a_margin = 0.1f) : margin(a_margin) {};
+
+    // to add a box, returns its proxy
+    int insert(const aabb &box, std::uint32_t user);
+
+    void remove(int proxy);
+
+    // to move a proxy's box, returns whether the tree had to change
+    bool move(int proxy, const aabb &box);
+
+    // to rebuild every subtree that refits grew past BVH_REBUILD_GROWTH, once per frame before querying
+    void rebuild_dirty();
+
+    // to remove every proxy, node storage is kept
+    void clear();
+
+    // to write the user value of every leaf touching the frustum to visible and return how many.
+    // visible must have room for every proxy
+    std::size_t cull(const frustum &view_frustum, std::uint32_t *visible) const;
+
+    // to visit every leaf whose fat box overlaps box, visit(user)
+    template <class F>
+    void overlap(const aabb &box, F &&visit) const;
+
+    // to visit leaves along a ray front to back, hit(user, max_t) returns the new max_t so closer hits prune the rest
+    template <class F>
+    void raycast(const glm::vec3 &origin, const glm::vec3 &dir, float max_t, F &&hit) const;
+
+    std::size_t size() const {return leaf_count;};
+    int get_height() const;
+    const aabb &get_fat_box(int proxy) const {return nodes[proxy].box;};
+    std::uint32_t get_user(int proxy) const {return nodes[proxy].user;};
+
+    // total area of the inner nodes over the root's, lower is a tighter tree
+    float get_sah_cost() const;
+
+private:
+    int allocate_node();
+    void free_node(int index);
+
+    aabb fatten(const aabb &box) const;
+
+    // to link a leaf next to the sibling that grows the tree's area the least
+    void insert_leaf(int leaf);
+    void remove_leaf(int leaf);
+
+    // to recompute the boxes from index up to the root, flagging nodes that grew too much
+    void refit_from(int index);
+
+    // to rebuild a subtree from its leaves, reusing its inner nodes
+    void rebuild(int index);
+    int build(std::size_t first, std::size_t last);
+
+    float margin;
+
+    std::vector<bvh_node> nodes{};
+    int root{BVH_NULL};
+    int free_list{BVH_NULL};
+    std::size_t leaf_count{0};
+
+    std::vector<int> dirty_nodes{};
+
+    // rebuild scratch, kept between rebuilds
+    std::vector<int> build_leaves{};
+    std::vector<int> build_inner{};
+
+    mutable std::vector<int> stack{};
+
+    // node and the frustum planes it still straddles, a node inside all of them is emitted without testing its leaves
+    mutable std::vector<std::pair<int, std::uint8_t>> cull_stack{};
+};
+
+template <class F>
+void bvh::overlap(const aabb &box, F &&visit) const
+{
+    if (root == BVH_NULL)
+        return;
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const bvh_node &node{nodes[stack.back()]};
+        stack.pop_back();
+
+        if (!node.box.overlaps(box))
+            continue;
+
+        if (node.is_leaf())
+        {
+            visit(node.user);
+            continue;
+        }
+
+        stack.push_back(node.left);
+        stack.push_back(node.right);
+    }
+}
+
+template <class F>
+void bvh::raycast(const glm::vec3 &origin, const glm::vec3 &dir, float max_t, F &&hit) const
+{
+    if (root == BVH_NULL)
+        return;
+
+    glm::vec3 inv_dir{1.0f / dir};
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const bvh_node &node{nodes[stack.back()]};
+        stack.pop_back();
+
+        // a closer hit may have shortened the ray since the node was pushed
+        if (node.box.raycast(origin, inv_dir, max_t) < 0.0f)
+            continue;
+
+        if (node.is_leaf())
+        {
+            max_t = hit(node.user, max_t);
+            continue;
+        }
+
+        float left_t{nodes[node.left].box.raycast(origin, inv_dir, max_t)};
+        float right_t{nodes[node.right].box.raycast(origin, inv_dir, max_t)};
+
+        // the nearer child is pushed last so it's visited first
+        std::pair<float, int> near{left_t, node.left}, far{right_t, node.right};
+        if (far.first >= 0.0f && (near.first < 0.0f || far.first < near.first))
+            std::swap(near, far);
+
+        if (far.first >= 0.0f)
+            stack.push_back(far.second);
+        if (near.first >= 0.0f)
+            stack.push_back(near.second);
+    }
+}
+
+#endif //BVH_H
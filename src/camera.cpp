@@ -1,6 +1,33 @@
 #include "camera.hpp"
 
-camera::camera()
+camera::camera(int r_width, int r_height)
+    : render_width(r_width), render_height(r_height)
 {
     proj = glm::ortho(-(float)render_width / 2, (float)render_width / 2, -(float)render_height / 2, (float)render_height / 2, -100.0f, 100.0f);
 }
+
+void camera::look_at(const glm::vec3 &a_pos, const glm::vec3 &target)
+{
+    pos = a_pos;
+    front = glm::normalize(target - pos);
+
+    update_front();
+}
+
+void camera::orbit(float angle, float radius)
+{
+    glm::vec3 a_pos{};
+    a_pos.x = radius * std::cos(glm::radians(angle));
+    a_pos.z = radius * std::sin(glm::radians(angle));
+    a_pos.y = radius;
+
+    look_at(a_pos, glm::vec3(0.0f));
+}
+
+void camera::update_front()
+{
+    right = glm::normalize(glm::cross(front, world_up));
+    up = glm::normalize(glm::cross(right, front));
+
+    view = glm::lookAt(pos, pos + front, up);
+}
@@ -8,10 +8,18 @@
 class camera
 {
 public:
-    camera();
+    camera(int r_width, int r_height);
     glm::mat4 &get_view() {return view;};
     glm::mat4 &get_proj() {return proj;};
     glm::vec3 &get_pos() {return pos;};
+    const glm::mat4 &get_view() const {return view;};
+    const glm::mat4 &get_proj() const {return proj;};
+
+    // to move the camera and point it at a target
+    void look_at(const glm::vec3 &a_pos, const glm::vec3 &target);
+
+    // to place the camera on a circle around the origin, raised by its radius, looking at the origin
+    void orbit(float angle, float radius);
 
 private:
     void update_front();
@@ -28,4 +36,4 @@ private:
     glm::mat4 proj{1.0f};
     glm::mat4 view{1.0f};
 };
-#endif // CAMERA_H
\ No newline at end of file
+#endif // CAMERA_H
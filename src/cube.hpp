@@ -1,83 +1,27 @@
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
+#include <type_traits>
 
-#include "shader.hpp"
+#include <glm/glm.hpp>
+
+#include "mesh.hpp"
 
 #ifndef CUBE_H
 #define CUBE_H
 
-class cube
+// a cube instance, the geometry lives once in the mesh registry.
+// pos and scale are adjacent so the instance buffer can read them as one vec4
+struct cube
 {
-public:
-    cube(shader &a_shader, int r_width, int r_height, glm::vec3 a_pos, glm::vec3 a_color);
-    void draw(glm::vec3 &light_color, glm::vec3 &light_pos, glm::vec3 &view_pos);
-
-    glm::vec3 &get_pos(){return pos;};
-    glm::vec3 &get_color(){return color;};
-
-    void set_pos(glm::vec3 &a_pos){pos = a_pos;};
-    void set_color(glm::vec3 &a_color){color = a_color;};
-
-private:
-    shader &c_shader;
-
-    int render_width, render_height;
-
-    unsigned int VAO{}, VBO{};
-
     glm::vec3 pos{};
-    glm::vec3 color{};
-
-    const float vertices[216]
-    {
-    // Back face
-    -0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-     0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-     0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-     0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-    -0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-    -0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
-
-    // Front face
-    -0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-     0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-     0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-     0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-    -0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-    -0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
-
-    // Left face
-    -0.5f,  0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
-
-    // Right face
-     0.5f,  0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
+    float scale{32.0f};
+    glm::vec3 color{1.0f};
+    mesh_id mesh_index{INVALID_MESH_ID};
+};
 
-    // Bottom face
-    -0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
-    -0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
+// cubes are streamed straight into the instance buffer and copied by value, keep them small and trivial
+static_assert(sizeof(cube) <= 32, "cube instance record grew");
+static_assert(std::is_trivially_copyable_v<cube>, "cube instance record must stay trivially copyable");
 
-    // Top face
-    -0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f
-};
+// the instance encoder reads cube records as rows of floats
+static_assert(sizeof(cube) % sizeof(float) == 0, "cube instance record must be a whole number of floats");
 
-};
-#endif //CUBE_H
\ No newline at end of file
+#endif //CUBE_H
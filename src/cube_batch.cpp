@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include "cube_batch.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+
+cube_batch::cube_batch(shader &a_shader, const mesh &a_mesh, bool packed)
+    : b_shader(a_shader), b_mesh(a_mesh), VAO(vertex_array::create()), instance_VBO(buffer::create())
+{
+    gl_state::get().bind_vertex_array(VAO.get());
+
+    // the cube geometry is shared, only the attribute setup is per batch
+    b_mesh.bind_attributes();
+
+    // per-instance attributes advance once per instance instead of once per vertex
+    gl_state::get().bind_buffer(GL_ARRAY_BUFFER, instance_VBO.get());
+
+    // position and scale stay full floats as one vec4, world positions outgrow half precision
+    instance_format.add(2, 4, attribute_type::float32, offsetof(cube, pos) / sizeof(float))
+                   .add(3, 3, packed ? attribute_type::unorm8 : attribute_type::float32, offsetof(cube, color) / sizeof(float));
+
+    instance_format.apply(1);
+
+    gl_state::get().bind_vertex_array(0);
+}
+
+// world space box of a cube, matching the instanced vertex shader
+static aabb cube_box(const cube &a_cube)
+{
+    return aabb{(a_cube.pos - 0.5f) * a_cube.scale, (a_cube.pos + 0.5f) * a_cube.scale};
+}
+
+std::size_t cube_batch::add(const cube &a_cube)
+{
+    cubes.push_back(a_cube);
+    boxes.add(glm::vec3(0.0f), glm::vec3(0.0f));
+    proxies.push_back(tree.insert(cube_box(a_cube), (std::uint32_t)(cubes.size() - 1)));
+    grow_bounds(cubes.size() - 1);
+    touch();
+
+    return cubes.size() - 1;
+}
+
+void cube_batch::clear()
+{
+    cubes.clear();
+    boxes.clear();
+    tree.clear();
+    proxies.clear();
+    visible_count = 0;
+    touch();
+}
+
+void cube_batch::grow_bounds(std::size_t index)
+{
+    const cube &a_cube{cubes[index]};
+    aabb box{cube_box(a_cube)};
+
+    glm::vec3 cube_min{box.min};
+    glm::vec3 cube_max{box.max};
+
+    boxes.set(index, box.center(), box.extent());
+    tree.move(proxies[index], box);
+
+    if (cubes.size() == 1)
+    {
+        bounds_min = cube_min;
+        bounds_max = cube_max;
+    }
+    else
+    {
+        bounds_min = glm::min(bounds_min, cube_min);
+        bounds_max = glm::max(bounds_max, cube_max);
+    }
+}
+
+void cube_batch::upload()
+{
+    if (!dirty)
+        return;
+
+    PROFILE_SCOPE("cube_batch::upload");
+    ALLOC_SCOPE("cube_batch");
+
+    gl_state::get().bind_buffer(GL_ARRAY_BUFFER, instance_VBO.get());
+
+    // grow geometrically so adding cubes one at a time doesn't reallocate every frame
+    if (visible_count > instance_capacity)
+        instance_capacity = std::max(visible_count, instance_capacity * 2);
+
+    visible_cubes.clear();
+    for (std::size_t i = 0; i < visible_count; i++)
+        visible_cubes.push_back(cubes[visible[i]]);
+
+    instance_format.encode(reinterpret_cast<const float *>(visible_cubes.data()), visible_cubes.size(), sizeof(cube) / sizeof(float), packed_instances);
+
+    // orphan the old storage so the driver doesn't stall on in-flight draws
+    glBufferData(GL_ARRAY_BUFFER, instance_capacity * instance_format.get_stride(), nullptr, GL_DYNAMIC_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 0, packed_instances.size(), packed_instances.data());
+
+    uploaded.assign(visible.begin(), visible.begin() + visible_count);
+    dirty = false;
+
+    g_render_stats.instances_copied += visible_count;
+}
+
+void cube_batch::cull(const frustum &view_frustum, occlusion_buffer *occluders)
+{
+    PROFILE_SCOPE("cube_batch::cull");
+    ALLOC_SCOPE("cube_batch");
+
+    // only grows, so a steady scene never reallocates
+    if (visible.size() < cubes.size())
+        visible.resize(cubes.size());
+
+    if (tree_culling)
+    {
+        tree.rebuild_dirty();
+        visible_count = tree.cull(view_frustum, visible.data());
+    }
+    else
+        visible_count = frustum_cull(view_frustum, boxes, visible.data());
+
+    if (occluders)
+        occlusion_cull(*occluders);
+
+    g_render_stats.instances_culled += cubes.size() - visible_count;
+
+    // a new visible set has to be streamed even if no cube changed
+    if (visible_count != uploaded.size() || !std::equal(uploaded.begin(), uploaded.end(), visible.begin()))
+        dirty = true;
+}
+
+void cube_batch::submit(render_queue &queue)
+{
+    PROFILE_SCOPE("cube_batch::submit");
+
+    if (visible_count == 0)
+        return;
+
+    render_packet packet{};
+
+    // the batch sorts by its closest corner, so it lands ahead of anything it covers
+    float depth{1.0f};
+
+    for (int corner{}; corner < 8; corner++)
+    {
+        glm::vec3 point{corner & 1 ? bounds_max.x : bounds_min.x,
+                        corner & 2 ? bounds_max.y : bounds_min.y,
+                        corner & 4 ? bounds_max.z : bounds_min.z};
+
+        depth = std::min(depth, queue.depth_of(point));
+    }
+
+    packet.key = queue.make_key(render_pass::opaque, b_shader, 0, VAO.get(), depth);
+    packet.program = &b_shader;
+    packet.VAO = VAO.get();
+    packet.vertex_count = b_mesh.get_index_count();
+    packet.index_type = b_mesh.get_index_type();
+    packet.instance_count = (GLsizei)visible_count;
+
+    // the instance buffer is streamed once the batch's vertex array is bound
+    packet.prepare = [](void *object) {static_cast<cube_batch *>(object)->upload();};
+    packet.object = this;
+
+    queue.submit(packet);
+}
+
+void cube_batch::occlusion_cull(occlusion_buffer &occluders)
+{
+    PROFILE_SCOPE("cube_batch::occlusion_cull");
+
+    occluder_candidates.assign(visible.begin(), visible.begin() + visible_count);
+
+    if (occluder_depths.size() < cubes.size())
+        occluder_depths.resize(cubes.size());
+
+    // cubes crossing the near or far plane can't be rasterized, they rank last
+    for (std::uint32_t index : occluder_candidates)
+    {
+        const cube &a_cube{cubes[index]};
+        occluder_depths[index] = occluders.can_occlude(cube_box(a_cube)) ? occluders.depth_of(a_cube.pos * a_cube.scale) : std::numeric_limits<float>::max();
+    }
+
+    // the biggest cubes hide the most, ties go to the nearest
+    auto better_occluder = [&](std::uint32_t a, std::uint32_t b)
+    {
+        bool a_usable{occluder_depths[a] != std::numeric_limits<float>::max()};
+        bool b_usable{occluder_depths[b] != std::numeric_limits<float>::max()};
+
+        if (a_usable != b_usable)
+            return a_usable;
+
+        if (cubes[a].scale != cubes[b].scale)
+            return cubes[a].scale > cubes[b].scale;
+
+        return occluder_depths[a] < occluder_depths[b];
+    };
+
+    std::size_t occluder_count{std::min<std::size_t>(OCCLUSION_MAX_OCCLUDERS, occluder_candidates.size())};
+    if (occluder_count < occluder_candidates.size())
+        std::nth_element(occluder_candidates.begin(), occluder_candidates.begin() + occluder_count, occluder_candidates.end(), better_occluder);
+
+    for (std::size_t i = 0; i < occluder_count; i++)
+        occluders.add_occluder(cube_box(cubes[occluder_candidates[i]]));
+
+    occluders.rasterize();
+
+    std::size_t kept{0};
+    for (std::size_t i = 0; i < visible_count; i++)
+    {
+        if (!occluders.occluded(cube_box(cubes[visible[i]])))
+            visible[kept++] = visible[i];
+    }
+
+    g_render_stats.instances_occluded += visible_count - kept;
+    visible_count = kept;
+}
+
+int cube_batch::raycast(const glm::vec3 &origin, const glm::vec3 &dir, float &t) const
+{
+    PROFILE_SCOPE("cube_batch::raycast");
+
+    int closest{-1};
+
+    // the tree holds fat boxes, every candidate is tested against its exact box
+    tree.raycast(origin, dir, std::numeric_limits<float>::max(), [&](std::uint32_t index, float max_t)
+    {
+        float hit{cube_box(cubes[index]).raycast(origin, 1.0f / dir, max_t)};
+        if (hit < 0.0f)
+            return max_t;
+
+        closest = (int)index;
+        t = hit;
+
+        return hit;
+    });
+
+    return closest;
+}
+
+void cube_batch::overlap(const aabb &box, std::vector<std::uint32_t> &indices) const
+{
+    PROFILE_SCOPE("cube_batch::overlap");
+
+    indices.clear();
+
+    tree.overlap(box, [&](std::uint32_t index)
+    {
+        if (cube_box(cubes[index]).overlaps(box))
+            indices.push_back(index);
+    });
+}
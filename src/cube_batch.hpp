@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "gl_handle.hpp"
+#include "mesh.hpp"
+#include "vertex_format.hpp"
+#include "cube.hpp"
+#include "frustum_cull.hpp"
+#include "bvh.hpp"
+#include "occlusion_buffer.hpp"
+#include "render_queue.hpp"
+#include "shader.hpp"
+
+#ifndef CUBE_BATCH_H
+#define CUBE_BATCH_H
+
+class cube_batch
+{
+public:
+    // packed instances send colors as 8-bit unorm, otherwise as floats
+    cube_batch(shader &a_shader, const mesh &a_mesh, bool packed = true);
+
+    cube_batch(const cube_batch &) = delete;
+    cube_batch &operator=(const cube_batch &) = delete;
+
+    // to add a cube instance, returns its index
+    std::size_t add(const cube &a_cube);
+
+    // to remove every instance
+    void clear();
+
+    // to find the instances inside the frustum, submit draws only those.
+    // with an occlusion buffer already begun for the view, the largest visible cubes are rasterized into it
+    // and cubes hidden behind them are dropped too
+    void cull(const frustum &view_frustum, occlusion_buffer *occluders = nullptr);
+
+    // to cull through the bvh, or by testing every cube with the flat simd kernels
+    void set_tree_culling(bool enabled) {tree_culling = enabled;};
+    bool get_tree_culling() const {return tree_culling;};
+
+    // to find the closest cube a ray hits, returns its index or -1 and sets t to the hit distance
+    int raycast(const glm::vec3 &origin, const glm::vec3 &dir, float &t) const;
+
+    // to collect the index of every cube overlapping box
+    void overlap(const aabb &box, std::vector<std::uint32_t> &indices) const;
+
+    // to submit the instances the last cull kept as a single instanced draw, camera and lights come from the per-frame uniform block
+    void submit(render_queue &queue);
+
+    std::size_t size() const {return cubes.size();};
+    std::size_t visible_size() const {return visible_count;};
+
+    // bumped by every change to the instances, to tell whether the batch needs drawing again
+    std::uint64_t get_version() const {return version;};
+
+    // read-only access never dirties the instance buffer
+    const cube &get(std::size_t index) const {return cubes[index];};
+
+    void set_pos(std::size_t index, const glm::vec3 &a_pos){cubes[index].pos = a_pos; grow_bounds(index); touch();};
+    void set_color(std::size_t index, const glm::vec3 &a_color){cubes[index].color = a_color; touch();};
+    void set_scale(std::size_t index, float a_scale){cubes[index].scale = a_scale; grow_bounds(index); touch();};
+
+private:
+    // to stream the instance data to the gpu, only when it changed
+    void upload();
+
+    // to rasterize the best occluders among the visible cubes and drop the visible cubes they hide
+    void occlusion_cull(occlusion_buffer &occluders);
+
+    // to grow the batch bounds to cover a cube and update its cull box, batch bounds only shrink on clear
+    void grow_bounds(std::size_t index);
+
+    shader &b_shader;
+
+    const mesh &b_mesh;
+
+    // the mesh's vertex attributes plus the per-instance attributes
+    vertex_array VAO{};
+    buffer instance_VBO{};
+
+    // number of instances the instance buffer can hold without reallocating
+    std::size_t instance_capacity{};
+
+    // to mark the instance buffer for upload after a change
+    void touch() {dirty = true; version++;};
+
+    bool dirty{true};
+    std::uint64_t version{0};
+
+    // world space bounds of every instance, used for the batch's sort depth
+    glm::vec3 bounds_min{0.0f};
+    glm::vec3 bounds_max{0.0f};
+
+    std::vector<cube> cubes;
+
+    // every cube's world space box, in the same order as cubes
+    cull_bounds boxes{};
+
+    // the same boxes in a tree, proxies[i] is cube i's leaf
+    bvh tree{};
+    std::vector<int> proxies{};
+    bool tree_culling{true};
+
+    // indices of the cubes the last cull kept, and the ones in the instance buffer now
+    std::vector<std::uint32_t> visible{};
+    std::size_t visible_count{0};
+    std::vector<std::uint32_t> uploaded{};
+
+    // the visible cubes gathered for encoding, kept between uploads
+    std::vector<cube> visible_cubes{};
+
+    // occluder selection scratch, depths are indexed by cube
+    std::vector<std::uint32_t> occluder_candidates{};
+    std::vector<float> occluder_depths{};
+
+    // float position and scale plus unorm8 color, 20 bytes per instance instead of a 32 byte cube record
+    vertex_format instance_format{};
+
+    // instance data encoded into instance_format, kept between uploads
+    std::vector<std::uint8_t> packed_instances{};
+};
+
+#endif //CUBE_BATCH_H
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <iostream>
+#include <new>
+
+#include "frame_arena.hpp"
+
+// to round an address or size up to a power of two alignment
+static std::uintptr_t align_up(std::uintptr_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(std::uintptr_t)(alignment - 1);
+}
+
+linear_resource::linear_resource(std::size_t a_capacity)
+    : block(static_cast<std::byte *>(::operator new(a_capacity, std::align_val_t{alignof(std::max_align_t)}))), capacity(a_capacity)
+{
+}
+
+linear_resource::~linear_resource()
+{
+    reset();
+    ::operator delete(block, std::align_val_t{alignof(std::max_align_t)});
+}
+
+void *linear_resource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::uintptr_t start{reinterpret_cast<std::uintptr_t>(block)};
+    std::uintptr_t aligned{align_up(start + used, alignment)};
+
+    if (aligned + bytes <= start + capacity)
+    {
+        used = aligned + bytes - start;
+        high_water = std::max(high_water, get_used());
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    // the header is padded to the alignment, so the allocation after it stays aligned
+    std::size_t header{align_up(sizeof(overflow_block), std::max(alignment, alignof(overflow_block)))};
+    std::size_t size{header + bytes};
+    std::size_t block_alignment{std::max(alignment, alignof(overflow_block))};
+
+    void *memory{::operator new(size, std::align_val_t{block_alignment})};
+    overflow_head = new (memory) overflow_block{overflow_head, size, block_alignment};
+
+    if (overflows++ == 0)
+        std::cout << "ERROR::FRAME_ARENA::OUT_OF_SPACE: " << capacity << " bytes per frame aren't enough, falling back to the heap" << std::endl;
+
+    overflow_bytes += bytes;
+    high_water = std::max(high_water, get_used());
+
+    return static_cast<std::byte *>(memory) + header;
+}
+
+void linear_resource::reset()
+{
+    while (overflow_head != nullptr)
+    {
+        overflow_block *next{overflow_head->next};
+        ::operator delete(overflow_head, overflow_head->size, std::align_val_t{overflow_head->alignment});
+        overflow_head = next;
+    }
+
+    used = 0;
+    overflow_bytes = 0;
+}
+
+frame_arena::frame_arena(std::size_t bytes_per_frame)
+    : arenas{linear_resource{bytes_per_frame}, linear_resource{bytes_per_frame}, linear_resource{bytes_per_frame}}
+{
+    static_assert(FRAME_ARENA_FRAMES == 3, "frame_arena's constructor makes one arena per frame");
+}
+
+void frame_arena::begin_frame()
+{
+    current = (current + 1) % FRAME_ARENA_FRAMES;
+    arenas[current].reset();
+}
+
+std::size_t frame_arena::get_high_water() const
+{
+    std::size_t high_water{0};
+    for (const linear_resource &arena : arenas)
+        high_water = std::max(high_water, arena.get_high_water());
+
+    return high_water;
+}
+
+std::uint64_t frame_arena::get_overflows() const
+{
+    std::uint64_t overflows{0};
+    for (const linear_resource &arena : arenas)
+        overflows += arena.get_overflows();
+
+    return overflows;
+}
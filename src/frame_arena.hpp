@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+// frames whose transient data stays valid at once, so data a frame hands to the gpu outlives the frame
+#define FRAME_ARENA_FRAMES 3
+
+// bytes each frame can bump allocate before falling back to the heap
+#define FRAME_ARENA_BYTES (4u << 20)
+
+// a bump allocator over one block. allocating moves a pointer, deallocating does nothing
+// and reset frees everything at once. allocations past the block go to the heap until the next reset
+class linear_resource : public std::pmr::memory_resource
+{
+public:
+    explicit linear_resource(std::size_t a_capacity);
+    ~linear_resource();
+
+    linear_resource(const linear_resource &) = delete;
+    linear_resource &operator=(const linear_resource &) = delete;
+
+    // to free every allocation, heap fallbacks included
+    void reset();
+
+    // bytes allocated since the last reset, heap fallbacks included
+    std::size_t get_used() const {return used + overflow_bytes;};
+    std::size_t get_capacity() const {return capacity;};
+
+    // the most bytes used between two resets
+    std::size_t get_high_water() const {return high_water;};
+
+    // allocations that didn't fit the block since it was created
+    std::uint64_t get_overflows() const {return overflows;};
+
+private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override {};
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {return this == &other;};
+
+    // heap blocks taken after the block ran out, chained through a header in front of each
+    struct overflow_block
+    {
+        overflow_block *next;
+        std::size_t size;
+        std::size_t alignment;
+    };
+
+    std::byte *block{nullptr};
+    std::size_t capacity{};
+    std::size_t used{0};
+
+    overflow_block *overflow_head{nullptr};
+    std::size_t overflow_bytes{0};
+    std::uint64_t overflows{0};
+
+    std::size_t high_water{0};
+};
+
+// an uninitialized array of trivially copyable values in a frame's arena
+template <typename T>
+struct frame_span
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "frame spans are never destroyed");
+
+    T *data{nullptr};
+    std::size_t size{0};
+
+    T &operator[](std::size_t index) {return data[index];};
+    const T &operator[](std::size_t index) const {return data[index];};
+
+    T *begin() {return data;};
+    T *end() {return data + size;};
+    const T *begin() const {return data;};
+    const T *end() const {return data + size;};
+};
+
+// a vector whose storage lives in a frame's arena, reserve up front since outgrown storage isn't reused
+template <typename T>
+using frame_vector = std::pmr::vector<T>;
+
+// FRAME_ARENA_FRAMES linear arenas used round-robin, one per frame. starting a frame resets
+// the arena it last used FRAME_ARENA_FRAMES frames ago, so everything in it is freed in O(1)
+class frame_arena
+{
+public:
+    explicit frame_arena(std::size_t bytes_per_frame = FRAME_ARENA_BYTES);
+
+    frame_arena(const frame_arena &) = delete;
+    frame_arena &operator=(const frame_arena &) = delete;
+
+    // to move on to the next arena and free what it held
+    void begin_frame();
+
+    // the current frame's arena, for std::pmr containers
+    std::pmr::memory_resource *get() {return &arenas[current];};
+
+    // to allocate an uninitialized span in the current frame
+    template <typename T>
+    frame_span<T> allocate(std::size_t count)
+    {
+        return frame_span<T>{static_cast<T *>(arenas[current].allocate(count * sizeof(T), alignof(T))), count};
+    };
+
+    // to make an empty vector in the current frame with room for count values
+    template <typename T>
+    frame_vector<T> make_vector(std::size_t count)
+    {
+        frame_vector<T> vector{get()};
+        vector.reserve(count);
+        return vector;
+    };
+
+    // bytes used by the current frame, and the most any frame has used
+    std::size_t get_used() const {return arenas[current].get_used();};
+    std::size_t get_high_water() const;
+
+    std::uint64_t get_overflows() const;
+
+private:
+    linear_resource arenas[FRAME_ARENA_FRAMES];
+    std::size_t current{0};
+};
+
+#endif //FRAME_ARENA_H
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+#include "frame_pacing.hpp"
+
+int fixed_timestep::advance(double frame_seconds)
+{
+    accumulator += std::min(frame_seconds, FIXED_TIMESTEP_MAX_FRAME);
+
+    int ticks{0};
+    while (accumulator >= dt)
+    {
+        accumulator -= dt;
+        ticks++;
+    }
+
+    return ticks;
+}
+
+void frame_limiter::set_fps(double fps)
+{
+    interval = std::chrono::steady_clock::duration::zero();
+    if (fps > 0.0)
+        interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+
+    next = std::chrono::steady_clock::time_point{};
+}
+
+void frame_limiter::wait()
+{
+    if (interval == std::chrono::steady_clock::duration::zero())
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+
+    // a frame that ran long starts the schedule over, instead of rushing the next frames to catch up
+    if (next == std::chrono::steady_clock::time_point{} || now - next > interval)
+        next = now;
+
+    next += interval;
+
+    if (next - now > FRAME_LIMITER_SPIN_MARGIN)
+        std::this_thread::sleep_for(next - now - FRAME_LIMITER_SPIN_MARGIN);
+
+    while (std::chrono::steady_clock::now() < next)
+        std::this_thread::yield();
+}
+
+bool parse_vsync(std::string_view name, vsync_mode &mode)
+{
+    if (name == "off")
+        mode = vsync_mode::off;
+    else if (name == "on")
+        mode = vsync_mode::on;
+    else if (name == "adaptive")
+        mode = vsync_mode::adaptive;
+    else
+        return false;
+
+    return true;
+}
+
+vsync_mode set_vsync(vsync_mode mode)
+{
+    if (mode == vsync_mode::adaptive && !glfwExtensionSupported("GLX_EXT_swap_control_tear") && !glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+        mode = vsync_mode::on;
+
+    switch (mode)
+    {
+    case vsync_mode::off: glfwSwapInterval(0); break;
+    case vsync_mode::on: glfwSwapInterval(1); break;
+    case vsync_mode::adaptive: glfwSwapInterval(-1); break;
+    }
+
+    return mode;
+}
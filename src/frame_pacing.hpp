@@ -0,0 +1,65 @@
+#include <chrono>
+#include <string_view>
+
+#ifndef FRAME_PACING_H
+#define FRAME_PACING_H
+
+// longest real frame the simulation catches up on, anything longer is dropped to avoid a spiral of death
+#define FIXED_TIMESTEP_MAX_FRAME 0.25
+
+// how long before the deadline the frame limiter stops sleeping and spins, sleeps overshoot by about this much
+#define FRAME_LIMITER_SPIN_MARGIN std::chrono::microseconds(1500)
+
+// steps a simulation at a fixed rate however fast frames come, with the leftover time for interpolating
+class fixed_timestep
+{
+public:
+    explicit fixed_timestep(double tick_rate = 60.0) : dt(1.0 / tick_rate) {};
+
+    // to add a frame's real time, returns how many ticks to simulate
+    int advance(double frame_seconds);
+
+    double get_dt() const {return dt;};
+
+    // how far the present lies between the last two ticks, 0 to 1
+    double get_alpha() const {return accumulator / dt;};
+
+private:
+    double dt{};
+    double accumulator{0.0};
+};
+
+// holds frames to a target rate, sleeping for most of the wait and spinning for the rest,
+// since sleeping alone wakes up late and spinning alone burns a core
+class frame_limiter
+{
+public:
+    // a rate of zero doesn't limit
+    explicit frame_limiter(double fps = 0.0) {set_fps(fps);};
+
+    void set_fps(double fps);
+
+    // to block until the next frame is due
+    void wait();
+
+private:
+    std::chrono::steady_clock::duration interval{};
+    std::chrono::steady_clock::time_point next{};
+};
+
+enum class vsync_mode
+{
+    off,
+    on,
+
+    // waits for vblank unless the frame is late, then swaps right away instead of waiting a whole refresh
+    adaptive
+};
+
+// to look a vsync mode up by name (off, on, adaptive), returns false if there is none
+bool parse_vsync(std::string_view name, vsync_mode &mode);
+
+// to set the current context's swap interval, adaptive falls back to on without swap_control_tear
+vsync_mode set_vsync(vsync_mode mode);
+
+#endif //FRAME_PACING_H
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "frame_stats.hpp"
+#include "profiler.hpp"
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    std::size_t rank{(std::size_t)std::ceil(p / 100.0 * sorted.size())};
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void frame_stats::record(double cpu_ms, double gpu_ms, double present_ms)
+{
+    frame_sample sample{frame_count, cpu_ms, gpu_ms, present_ms, present_ms > hitch_ms};
+
+    if (samples.size() < FRAME_STATS_CAPACITY)
+        samples.push_back(sample);
+    else
+        samples[frame_count % FRAME_STATS_CAPACITY] = sample;
+
+    frame_count++;
+
+    if (!sample.hitch)
+        return;
+
+    frame_hitch hitch{sample};
+
+    std::vector<profile_event> events{};
+    profiler::get().current_frame_scopes(events);
+
+    std::size_t kept{std::min<std::size_t>(events.size(), FRAME_STATS_HITCH_SCOPES)};
+    std::partial_sort(events.begin(), events.begin() + kept, events.end(),
+                      [](const profile_event &a, const profile_event &b) {return a.duration > b.duration;});
+
+    for (std::size_t i = 0; i < kept; i++)
+        hitch.scopes.push_back(frame_hitch::scope{events[i].name, events[i].duration / 1.0e6});
+
+    if (hitches.size() >= FRAME_STATS_MAX_HITCHES)
+        hitches.erase(hitches.begin());
+
+    hitches.push_back(hitch);
+}
+
+frame_percentiles frame_stats::get_percentiles(double frame_sample::*field) const
+{
+    std::vector<double> sorted{};
+    sorted.reserve(samples.size());
+
+    for (const frame_sample &sample : samples)
+    {
+        if (sample.*field >= 0.0)
+            sorted.push_back(sample.*field);
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    return frame_percentiles{percentile(sorted, 50.0), percentile(sorted, 95.0), percentile(sorted, 99.0), sorted.empty() ? 0.0 : sorted.back()};
+}
+
+double frame_stats::get_cpu_ms_saved() const
+{
+    if (samples.empty())
+        return 0.0;
+
+    double total{0.0};
+    for (const frame_sample &sample : samples)
+        total += sample.cpu_ms;
+
+    return skipped_frames * total / samples.size();
+}
+
+bool frame_stats::write_csv(const std::string &path) const
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cout << "ERROR::FRAME_STATS::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file << "frame,cpu_ms,gpu_ms,present_ms,hitch\n";
+
+    // once the ring is full, the oldest sample sits where the next one goes
+    std::size_t oldest{samples.size() < FRAME_STATS_CAPACITY ? 0 : frame_count % FRAME_STATS_CAPACITY};
+
+    for (std::size_t i = 0; i < samples.size(); i++)
+    {
+        const frame_sample &sample{samples[(oldest + i) % samples.size()]};
+        file << sample.frame << "," << sample.cpu_ms << "," << sample.gpu_ms << "," << sample.present_ms << "," << sample.hitch << "\n";
+    }
+
+    return true;
+}
+
+// to write percentiles as a json object
+static void write_percentiles(std::ofstream &file, const frame_percentiles &percentiles)
+{
+    file << "{\"p50\": " << percentiles.p50 << ", \"p95\": " << percentiles.p95
+         << ", \"p99\": " << percentiles.p99 << ", \"max\": " << percentiles.max << "}";
+}
+
+bool frame_stats::write_json(const std::string &path) const
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cout << "ERROR::FRAME_STATS::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file << "{\n";
+    file << "  \"frames\": " << frame_count << ",\n";
+    file << "  \"window\": " << samples.size() << ",\n";
+    file << "  \"hitch_ms\": " << hitch_ms << ",\n";
+    file << "  \"skipped_frames\": " << skipped_frames << ",\n";
+    file << "  \"represented_frames\": " << represented_frames << ",\n";
+    file << "  \"idle_ms\": " << idle_ms << ",\n";
+    file << "  \"cpu_ms_saved\": " << get_cpu_ms_saved() << ",\n";
+    file << "  \"cpu_ms\": "; write_percentiles(file, get_percentiles(&frame_sample::cpu_ms)); file << ",\n";
+    file << "  \"gpu_ms\": "; write_percentiles(file, get_percentiles(&frame_sample::gpu_ms)); file << ",\n";
+    file << "  \"present_ms\": "; write_percentiles(file, get_percentiles(&frame_sample::present_ms)); file << ",\n";
+    file << "  \"hitches\": [";
+
+    for (std::size_t i = 0; i < hitches.size(); i++)
+    {
+        const frame_hitch &hitch{hitches[i]};
+
+        file << (i ? ",\n" : "\n") << "    {\"frame\": " << hitch.sample.frame << ", \"present_ms\": " << hitch.sample.present_ms
+             << ", \"cpu_ms\": " << hitch.sample.cpu_ms << ", \"gpu_ms\": " << hitch.sample.gpu_ms << ", \"scopes\": [";
+
+        for (std::size_t j = 0; j < hitch.scopes.size(); j++)
+            file << (j ? ", " : "") << "{\"name\": \"" << hitch.scopes[j].name << "\", \"ms\": " << hitch.scopes[j].ms << "}";
+
+        file << "]}";
+    }
+
+    file << (hitches.empty() ? "]\n" : "\n  ]\n");
+    file << "}\n";
+
+    return true;
+}
@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+// frames the rolling statistics cover
+#define FRAME_STATS_CAPACITY 1024
+
+// hitches kept for the report, the oldest are dropped first
+#define FRAME_STATS_MAX_HITCHES 256
+
+// longest profiler scopes recorded with each hitch
+#define FRAME_STATS_HITCH_SCOPES 4
+
+struct frame_sample
+{
+    std::uint64_t frame{};
+
+    // cpu time spent on the frame, gpu time of its passes (negative when unknown),
+    // and time since the previous present
+    double cpu_ms{};
+    double gpu_ms{-1.0};
+    double present_ms{};
+
+    bool hitch{false};
+};
+
+struct frame_percentiles
+{
+    double p50{};
+    double p95{};
+    double p99{};
+    double max{};
+};
+
+// a frame whose present interval went over the hitch threshold
+struct frame_hitch
+{
+    struct scope
+    {
+        const char *name{};
+        double ms{};
+    };
+
+    frame_sample sample{};
+
+    // the frame's longest profiler scopes, empty without OXIDIZER_PROFILE
+    std::vector<scope> scopes{};
+};
+
+// nearest-rank percentile of sorted samples, p from 0 to 100
+double percentile(const std::vector<double> &sorted, double p);
+
+// keeps the last FRAME_STATS_CAPACITY frames for rolling percentiles and flags hitches
+class frame_stats
+{
+public:
+    explicit frame_stats(double a_hitch_ms = 33.3) : hitch_ms(a_hitch_ms) {};
+
+    // to record a frame, before the profiler's end of frame so its scopes can be blamed for a hitch
+    void record(double cpu_ms, double gpu_ms, double present_ms);
+
+    // to get the rolling percentiles of one of a sample's times, unknown gpu times are left out
+    frame_percentiles get_percentiles(double frame_sample::*field) const;
+
+    // to count a frame that wasn't drawn because nothing changed, and the time spent waiting instead
+    void record_skipped(double waited_ms) {skipped_frames++; idle_ms += waited_ms;};
+
+    // to count a frame that presented the last image again without rendering, still recorded as a frame
+    void record_represented() {represented_frames++;};
+
+    std::uint64_t get_skipped_frames() const {return skipped_frames;};
+    std::uint64_t get_represented_frames() const {return represented_frames;};
+
+    // cpu time the skipped frames would have cost, at the mean cpu time of recorded frames
+    double get_cpu_ms_saved() const;
+
+    const std::vector<frame_hitch> &get_hitches() const {return hitches;};
+    std::uint64_t get_frame_count() const {return frame_count;};
+
+    double get_hitch_ms() const {return hitch_ms;};
+    void set_hitch_ms(double a_hitch_ms) {hitch_ms = a_hitch_ms;};
+
+    // to write the retained frames, oldest first, as frame,cpu_ms,gpu_ms,present_ms,hitch
+    bool write_csv(const std::string &path) const;
+
+    // to write the rolling percentiles and every kept hitch
+    bool write_json(const std::string &path) const;
+
+private:
+    std::vector<frame_sample> samples{};
+    std::uint64_t frame_count{0};
+
+    std::vector<frame_hitch> hitches{};
+
+    double hitch_ms{};
+
+    // render on demand
+    std::uint64_t skipped_frames{0};
+    std::uint64_t represented_frames{0};
+    double idle_ms{0.0};
+};
+
+#endif //FRAME_STATS_H
@@ -0,0 +1,63 @@
+#include <cstring>
+
+#include "frame_uniforms.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
+
+frame_uniforms::frame_uniforms()
+    : UBO(buffer::create())
+{
+    gl_state::get().bind_buffer(GL_UNIFORM_BUFFER, UBO.get());
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(frame_block), nullptr, GL_DYNAMIC_DRAW);
+    gl_state::get().bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+    // attach the whole buffer to the shared binding point
+    gl_state::get().bind_buffer_base(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, UBO.get());
+}
+
+void frame_uniforms::set_camera(camera &a_camera)
+{
+    block.view = a_camera.get_view();
+    block.projection = a_camera.get_proj();
+    block.view_projection = a_camera.get_proj() * a_camera.get_view();
+    block.view_pos = glm::vec4(a_camera.get_pos(), 1.0f);
+}
+
+void frame_uniforms::clear_lights()
+{
+    block.light_count.x = 0;
+}
+
+void frame_uniforms::add_light(const glm::vec3 &a_pos, const glm::vec3 &a_color)
+{
+    if (block.light_count.x >= MAX_LIGHTS)
+        return;
+
+    block.light_pos[block.light_count.x] = glm::vec4(a_pos, 1.0f);
+    block.light_color[block.light_count.x] = glm::vec4(a_color, 1.0f);
+    block.light_count.x++;
+}
+
+bool frame_uniforms::changed() const
+{
+    return first_upload || std::memcmp(&block, &uploaded, sizeof(frame_block)) != 0;
+}
+
+void frame_uniforms::upload()
+{
+    // a static camera and static lights cost nothing
+    if (!changed())
+        return;
+
+    PROFILE_SCOPE("frame_uniforms::upload");
+
+    gl_state::get().bind_buffer(GL_UNIFORM_BUFFER, UBO.get());
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(frame_block), &block);
+    gl_state::get().bind_buffer(GL_UNIFORM_BUFFER, 0);
+
+    g_render_stats.uniform_bytes += sizeof(frame_block);
+
+    uploaded = block;
+    first_upload = false;
+}
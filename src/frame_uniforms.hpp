@@ -0,0 +1,67 @@
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "camera.hpp"
+#include "gl_handle.hpp"
+
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+// uniform buffer binding point shared by every program that declares the frame_data block
+#define FRAME_UNIFORM_BINDING 0
+
+#define MAX_LIGHTS 8
+
+// mirrors the std140 frame_data block in the shaders, every member is 16 byte aligned
+struct frame_block
+{
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::mat4 view_projection{1.0f};
+
+    // w is unused
+    glm::vec4 view_pos{0.0f};
+
+    glm::vec4 light_pos[MAX_LIGHTS]{};
+    glm::vec4 light_color[MAX_LIGHTS]{};
+
+    // x is the number of active lights
+    glm::ivec4 light_count{0};
+};
+
+class frame_uniforms
+{
+public:
+    frame_uniforms();
+
+    frame_uniforms(const frame_uniforms &) = delete;
+    frame_uniforms &operator=(const frame_uniforms &) = delete;
+
+    // to set the view, projection and view position from a camera
+    void set_camera(camera &a_camera);
+
+    // to remove every light, call before adding this frame's lights
+    void clear_lights();
+
+    // to add a light, lights past MAX_LIGHTS are ignored
+    void add_light(const glm::vec3 &a_pos, const glm::vec3 &a_color);
+
+    // whether the block differs from the last upload
+    bool changed() const;
+
+    // to upload the block once for the frame, skipped if nothing changed
+    void upload();
+
+private:
+    buffer UBO{};
+
+    // the block being built this frame
+    frame_block block{};
+
+    // the block currently in the uniform buffer
+    frame_block uploaded{};
+
+    bool first_upload{true};
+};
+
+#endif //FRAME_UNIFORMS_H
@@ -0,0 +1,267 @@
+#include <cmath>
+
+#include <glm/simd/platform.h>
+
+#include "frustum_cull.hpp"
+#include "profiler.hpp"
+
+// the sse2 and avx2 kernels are built with per-function target attributes, so the rest of the build needs no -m flags
+#if (GLM_ARCH & GLM_ARCH_X86_BIT) && defined(__GNUC__)
+#define FRUSTUM_CULL_X86
+#include <immintrin.h>
+#endif
+
+frustum frustum::from_matrix(const glm::mat4 &view_projection)
+{
+    // glm is column major, so row i is the i-th component of every column
+    auto row = [&](int i) {return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);};
+
+    frustum result{};
+
+    result.planes[0] = row(3) + row(0);
+    result.planes[1] = row(3) - row(0);
+    result.planes[2] = row(3) + row(1);
+    result.planes[3] = row(3) - row(1);
+    result.planes[4] = row(3) + row(2);
+    result.planes[5] = row(3) - row(2);
+
+    for (glm::vec4 &plane : result.planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    return result;
+}
+
+std::size_t cull_bounds::add(const glm::vec3 &center, const glm::vec3 &extent)
+{
+    center_x.push_back(center.x);
+    center_y.push_back(center.y);
+    center_z.push_back(center.z);
+
+    extent_x.push_back(extent.x);
+    extent_y.push_back(extent.y);
+    extent_z.push_back(extent.z);
+
+    return size() - 1;
+}
+
+void cull_bounds::set(std::size_t index, const glm::vec3 &center, const glm::vec3 &extent)
+{
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+
+    extent_x[index] = extent.x;
+    extent_y[index] = extent.y;
+    extent_z[index] = extent.z;
+}
+
+void cull_bounds::clear()
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+
+    extent_x.clear();
+    extent_y.clear();
+    extent_z.clear();
+}
+
+// a box is outside when its center is further behind a plane than its extent reaches along the plane normal
+static bool box_visible(const frustum &view_frustum, const cull_bounds &bounds, std::size_t i)
+{
+    for (const glm::vec4 &plane : view_frustum.planes)
+    {
+        float distance{plane.x * bounds.center_x[i] + plane.y * bounds.center_y[i] + plane.z * bounds.center_z[i] + plane.w};
+        float radius{std::abs(plane.x) * bounds.extent_x[i] + std::abs(plane.y) * bounds.extent_y[i] + std::abs(plane.z) * bounds.extent_z[i]};
+
+        if (distance + radius < 0.0f)
+            return false;
+    }
+
+    return true;
+}
+
+// to cull boxes first to bounds.size() one at a time, the vector kernels finish their tails with it
+static std::size_t cull_scalar_range(const frustum &view_frustum, const cull_bounds &bounds, std::size_t first, std::uint32_t *visible)
+{
+    std::size_t count{0};
+
+    for (std::size_t i = first; i < bounds.size(); i++)
+    {
+        // branchless compaction, the slot is overwritten when the box is culled
+        visible[count] = (std::uint32_t)i;
+        count += box_visible(view_frustum, bounds, i);
+    }
+
+    return count;
+}
+
+static std::size_t cull_scalar(const frustum &view_frustum, const cull_bounds &bounds, std::uint32_t *visible)
+{
+    return cull_scalar_range(view_frustum, bounds, 0, visible);
+}
+
+#ifdef FRUSTUM_CULL_X86
+
+__attribute__((target("sse2")))
+static std::size_t cull_sse2(const frustum &view_frustum, const cull_bounds &bounds, std::uint32_t *visible)
+{
+    const __m128 sign_mask{_mm_set1_ps(-0.0f)};
+    const __m128 zero{_mm_setzero_ps()};
+
+    std::size_t count{0};
+    std::size_t i{0};
+
+    for (; i + 4 <= bounds.size(); i += 4)
+    {
+        __m128 cx{_mm_loadu_ps(&bounds.center_x[i])};
+        __m128 cy{_mm_loadu_ps(&bounds.center_y[i])};
+        __m128 cz{_mm_loadu_ps(&bounds.center_z[i])};
+        __m128 ex{_mm_loadu_ps(&bounds.extent_x[i])};
+        __m128 ey{_mm_loadu_ps(&bounds.extent_y[i])};
+        __m128 ez{_mm_loadu_ps(&bounds.extent_z[i])};
+
+        __m128 inside{_mm_castsi128_ps(_mm_set1_epi32(-1))};
+
+        for (const glm::vec4 &plane : view_frustum.planes)
+        {
+            __m128 nx{_mm_set1_ps(plane.x)};
+            __m128 ny{_mm_set1_ps(plane.y)};
+            __m128 nz{_mm_set1_ps(plane.z)};
+
+            __m128 distance{_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                       _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane.w)))};
+
+            __m128 radius{_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, nx), ex),
+                                                _mm_mul_ps(_mm_andnot_ps(sign_mask, ny), ey)),
+                                     _mm_mul_ps(_mm_andnot_ps(sign_mask, nz), ez))};
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        int mask{_mm_movemask_ps(inside)};
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            visible[count] = (std::uint32_t)(i + lane);
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cull_scalar_range(view_frustum, bounds, i, visible + count);
+}
+
+__attribute__((target("avx2,fma")))
+static std::size_t cull_avx2(const frustum &view_frustum, const cull_bounds &bounds, std::uint32_t *visible)
+{
+    const __m256 sign_mask{_mm256_set1_ps(-0.0f)};
+    const __m256 zero{_mm256_setzero_ps()};
+
+    std::size_t count{0};
+    std::size_t i{0};
+
+    for (; i + 8 <= bounds.size(); i += 8)
+    {
+        __m256 cx{_mm256_loadu_ps(&bounds.center_x[i])};
+        __m256 cy{_mm256_loadu_ps(&bounds.center_y[i])};
+        __m256 cz{_mm256_loadu_ps(&bounds.center_z[i])};
+        __m256 ex{_mm256_loadu_ps(&bounds.extent_x[i])};
+        __m256 ey{_mm256_loadu_ps(&bounds.extent_y[i])};
+        __m256 ez{_mm256_loadu_ps(&bounds.extent_z[i])};
+
+        __m256 inside{_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+
+        for (const glm::vec4 &plane : view_frustum.planes)
+        {
+            __m256 nx{_mm256_set1_ps(plane.x)};
+            __m256 ny{_mm256_set1_ps(plane.y)};
+            __m256 nz{_mm256_set1_ps(plane.z)};
+
+            __m256 distance{_mm256_fmadd_ps(nx, cx, _mm256_fmadd_ps(ny, cy, _mm256_fmadd_ps(nz, cz, _mm256_set1_ps(plane.w))))};
+
+            __m256 radius{_mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, nx), ex,
+                                          _mm256_fmadd_ps(_mm256_andnot_ps(sign_mask, ny), ey,
+                                                          _mm256_mul_ps(_mm256_andnot_ps(sign_mask, nz), ez)))};
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+        }
+
+        int mask{_mm256_movemask_ps(inside)};
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            visible[count] = (std::uint32_t)(i + lane);
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + cull_scalar_range(view_frustum, bounds, i, visible + count);
+}
+
+#endif
+
+static bool kernel_supported(cull_kernel kernel)
+{
+#ifdef FRUSTUM_CULL_X86
+    __builtin_cpu_init();
+
+    switch (kernel)
+    {
+    case cull_kernel::avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case cull_kernel::sse2: return __builtin_cpu_supports("sse2");
+    case cull_kernel::scalar: return true;
+    }
+
+    return false;
+#else
+    return kernel == cull_kernel::scalar;
+#endif
+}
+
+static cull_kernel best_kernel(cull_kernel at_most)
+{
+    for (cull_kernel kernel : {cull_kernel::avx2, cull_kernel::sse2})
+        if (kernel <= at_most && kernel_supported(kernel))
+            return kernel;
+
+    return cull_kernel::scalar;
+}
+
+static cull_kernel active_kernel{best_kernel(cull_kernel::avx2)};
+
+cull_kernel get_cull_kernel()
+{
+    return active_kernel;
+}
+
+cull_kernel set_cull_kernel(cull_kernel kernel)
+{
+    active_kernel = best_kernel(kernel);
+    return active_kernel;
+}
+
+const char *cull_kernel_name(cull_kernel kernel)
+{
+    switch (kernel)
+    {
+    case cull_kernel::scalar: return "scalar";
+    case cull_kernel::sse2: return "sse2";
+    case cull_kernel::avx2: return "avx2";
+    }
+
+    return "unknown";
+}
+
+std::size_t frustum_cull(const frustum &view_frustum, const cull_bounds &bounds, std::uint32_t *visible)
+{
+    PROFILE_SCOPE("frustum_cull");
+
+    switch (active_kernel)
+    {
+#ifdef FRUSTUM_CULL_X86
+    case cull_kernel::avx2: return cull_avx2(view_frustum, bounds, visible);
+    case cull_kernel::sse2: return cull_sse2(view_frustum, bounds, visible);
+#endif
+    default: return cull_scalar(view_frustum, bounds, visible);
+    }
+}
@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#ifndef FRUSTUM_CULL_H
+#define FRUSTUM_CULL_H
+
+// the six clip planes of a view-projection matrix, a point p is inside a plane when dot(plane.xyz, p) + plane.w >= 0
+struct frustum
+{
+    // left, right, bottom, top, near, far
+    glm::vec4 planes[6]{};
+
+    // to extract the planes from a view-projection matrix, normalized so distances are in world units
+    static frustum from_matrix(const glm::mat4 &view_projection);
+};
+
+// axis aligned boxes as centers and half extents, one array per component so a kernel loads 4 or 8 boxes at once
+struct cull_bounds
+{
+    std::vector<float> center_x{}, center_y{}, center_z{};
+    std::vector<float> extent_x{}, extent_y{}, extent_z{};
+
+    // to append a box, returns its index
+    std::size_t add(const glm::vec3 &center, const glm::vec3 &extent);
+
+    void set(std::size_t index, const glm::vec3 &center, const glm::vec3 &extent);
+
+    void clear();
+
+    std::size_t size() const {return center_x.size();};
+};
+
+enum class cull_kernel
+{
+    scalar,
+    sse2,
+    avx2
+};
+
+// to get the kernel frustum_cull uses, picked once from what the cpu supports
+cull_kernel get_cull_kernel();
+
+// to force a kernel, returns the one actually used since an unsupported kernel falls back to the best supported one
+cull_kernel set_cull_kernel(cull_kernel kernel);
+
+const char *cull_kernel_name(cull_kernel kernel);
+
+// to write the indices of every box at least partly inside the frustum to visible, in order, and return how many.
+// visible must have room for every box
+std::size_t frustum_cull(const frustum &view_frustum, const cull_bounds &bounds, std::uint32_t *visible);
+
+#endif //FRUSTUM_CULL_H
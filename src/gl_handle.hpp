@@ -0,0 +1,114 @@
+#include <type_traits>
+#include <utility>
+
+#include <glad/glad.h>
+
+#include "gl_state.hpp"
+
+#ifndef GL_HANDLE_H
+#define GL_HANDLE_H
+
+// a move-only owner of a GL object name, the object is deleted when the handle goes out of scope
+template <typename Traits>
+class gl_handle
+{
+public:
+    // an empty handle that owns nothing
+    gl_handle() = default;
+
+    // to take ownership of an existing object name
+    explicit gl_handle(unsigned int a_id) : id(a_id) {};
+
+    ~gl_handle() {reset();};
+
+    gl_handle(const gl_handle &) = delete;
+    gl_handle &operator=(const gl_handle &) = delete;
+
+    gl_handle(gl_handle &&other) noexcept : id(other.release()) {};
+
+    gl_handle &operator=(gl_handle &&other) noexcept
+    {
+        if (this != &other)
+            reset(other.release());
+
+        return *this;
+    };
+
+    // to create a new object
+    static gl_handle create() {return gl_handle{Traits::create()};};
+
+    unsigned int get() const {return id;};
+
+    explicit operator bool() const {return id != 0;};
+
+    // to give up ownership without deleting the object
+    unsigned int release() {return std::exchange(id, 0u);};
+
+    // to delete the owned object and optionally take ownership of another
+    void reset(unsigned int a_id = 0)
+    {
+        if (id != 0)
+            Traits::destroy(id);
+
+        id = a_id;
+    };
+
+private:
+    unsigned int id{};
+};
+
+struct vertex_array_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenVertexArrays(1, &id); return id;};
+    static void destroy(unsigned int id) {gl_state::get().forget_vertex_array(id); glDeleteVertexArrays(1, &id);};
+};
+
+struct buffer_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenBuffers(1, &id); return id;};
+    static void destroy(unsigned int id) {gl_state::get().forget_buffer(id); glDeleteBuffers(1, &id);};
+};
+
+struct framebuffer_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenFramebuffers(1, &id); return id;};
+    static void destroy(unsigned int id) {gl_state::get().forget_framebuffer(id); glDeleteFramebuffers(1, &id);};
+};
+
+struct renderbuffer_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenRenderbuffers(1, &id); return id;};
+    static void destroy(unsigned int id) {gl_state::get().forget_renderbuffer(id); glDeleteRenderbuffers(1, &id);};
+};
+
+struct texture_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenTextures(1, &id); return id;};
+    static void destroy(unsigned int id) {gl_state::get().forget_texture(id); glDeleteTextures(1, &id);};
+};
+
+struct query_traits
+{
+    static unsigned int create() {unsigned int id{}; glGenQueries(1, &id); return id;};
+    static void destroy(unsigned int id) {glDeleteQueries(1, &id);};
+};
+
+struct program_traits
+{
+    static unsigned int create() {return glCreateProgram();};
+    static void destroy(unsigned int id) {gl_state::get().forget_program(id); glDeleteProgram(id);};
+};
+
+using vertex_array = gl_handle<vertex_array_traits>;
+using buffer = gl_handle<buffer_traits>;
+using framebuffer = gl_handle<framebuffer_traits>;
+using renderbuffer = gl_handle<renderbuffer_traits>;
+using texture = gl_handle<texture_traits>;
+using query = gl_handle<query_traits>;
+using program_handle = gl_handle<program_traits>;
+
+static_assert(!std::is_copy_constructible_v<buffer> && !std::is_copy_assignable_v<buffer>, "GL handles must not be copyable");
+static_assert(std::is_nothrow_move_constructible_v<buffer>, "GL handles must be cheap to move");
+static_assert(sizeof(buffer) == sizeof(unsigned int), "GL handles must be as small as the name they own");
+
+#endif //GL_HANDLE_H
@@ -0,0 +1,309 @@
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+
+static const GLenum tracked_buffer_targets[8]
+{
+    GL_ARRAY_BUFFER,
+    GL_ELEMENT_ARRAY_BUFFER,
+    GL_UNIFORM_BUFFER,
+    GL_COPY_READ_BUFFER,
+    GL_COPY_WRITE_BUFFER,
+    GL_PIXEL_PACK_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER,
+    GL_TEXTURE_BUFFER
+};
+
+gl_state &gl_state::get()
+{
+    static gl_state state{};
+    return state;
+}
+
+void gl_state::issued()
+{
+    g_render_stats.state_calls_issued++;
+}
+
+void gl_state::skipped()
+{
+    g_render_stats.state_calls_skipped++;
+}
+
+int gl_state::buffer_slot(GLenum target)
+{
+    for (int i{}; i < 8; i++)
+    {
+        if (tracked_buffer_targets[i] == target)
+            return i;
+    }
+
+    return -1;
+}
+
+void gl_state::use_program(unsigned int a_program)
+{
+    if (program == a_program)
+        return skipped();
+
+    glUseProgram(a_program);
+    program = a_program;
+
+    issued();
+    g_render_stats.program_binds++;
+}
+
+void gl_state::bind_vertex_array(unsigned int a_vertex_array)
+{
+    if (vertex_array == a_vertex_array)
+        return skipped();
+
+    glBindVertexArray(a_vertex_array);
+    vertex_array = a_vertex_array;
+
+    // the element array binding belongs to the vertex array
+    buffers[1] = unknown;
+
+    issued();
+    g_render_stats.vao_binds++;
+}
+
+void gl_state::bind_buffer(GLenum target, unsigned int buffer)
+{
+    int slot{buffer_slot(target)};
+
+    if (slot >= 0 && buffers[slot] == buffer)
+        return skipped();
+
+    glBindBuffer(target, buffer);
+
+    if (slot >= 0)
+        buffers[slot] = buffer;
+
+    issued();
+}
+
+void gl_state::bind_buffer_base(GLenum target, unsigned int index, unsigned int buffer)
+{
+    // indexed bindings aren't shadowed, they are set rarely
+    glBindBufferBase(target, index, buffer);
+
+    int slot{buffer_slot(target)};
+
+    if (slot >= 0)
+        buffers[slot] = buffer;
+
+    issued();
+}
+
+void gl_state::bind_framebuffer(GLenum target, unsigned int framebuffer)
+{
+    bool read{target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER};
+    bool draw{target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER};
+
+    if ((!read || read_framebuffer == framebuffer) && (!draw || draw_framebuffer == framebuffer))
+        return skipped();
+
+    glBindFramebuffer(target, framebuffer);
+
+    if (read)
+        read_framebuffer = framebuffer;
+
+    if (draw)
+        draw_framebuffer = framebuffer;
+
+    issued();
+}
+
+void gl_state::bind_renderbuffer(unsigned int a_renderbuffer)
+{
+    if (renderbuffer == a_renderbuffer)
+        return skipped();
+
+    glBindRenderbuffer(GL_RENDERBUFFER, a_renderbuffer);
+    renderbuffer = a_renderbuffer;
+
+    issued();
+}
+
+void gl_state::active_texture(GLenum unit)
+{
+    if (active_unit == unit)
+        return skipped();
+
+    glActiveTexture(unit);
+    active_unit = unit;
+
+    issued();
+}
+
+void gl_state::bind_texture(GLenum target, unsigned int texture)
+{
+    // only 2D bindings on the first units are shadowed
+    unsigned int unit_index{active_unit == unknown ? unknown : active_unit - GL_TEXTURE0};
+    bool tracked{target == GL_TEXTURE_2D && unit_index < GL_STATE_TEXTURE_UNITS};
+
+    if (tracked && textures[unit_index] == texture)
+        return skipped();
+
+    glBindTexture(target, texture);
+
+    if (tracked)
+        textures[unit_index] = texture;
+
+    issued();
+}
+
+void gl_state::enable(GLenum capability)
+{
+    int slot{-1};
+
+    for (int i{}; i < capability_count; i++)
+    {
+        if (capabilities[i] == capability)
+            slot = i;
+    }
+
+    if (slot >= 0 && capability_states[slot] == 1)
+        return skipped();
+
+    glEnable(capability);
+
+    if (slot < 0 && capability_count < GL_STATE_CAPABILITIES)
+    {
+        slot = capability_count++;
+        capabilities[slot] = capability;
+    }
+
+    if (slot >= 0)
+        capability_states[slot] = 1;
+
+    issued();
+}
+
+void gl_state::disable(GLenum capability)
+{
+    int slot{-1};
+
+    for (int i{}; i < capability_count; i++)
+    {
+        if (capabilities[i] == capability)
+            slot = i;
+    }
+
+    if (slot >= 0 && capability_states[slot] == 0)
+        return skipped();
+
+    glDisable(capability);
+
+    if (slot < 0 && capability_count < GL_STATE_CAPABILITIES)
+    {
+        slot = capability_count++;
+        capabilities[slot] = capability;
+    }
+
+    if (slot >= 0)
+        capability_states[slot] = 0;
+
+    issued();
+}
+
+void gl_state::viewport(int x, int y, int width, int height)
+{
+    if (viewport_known && viewport_rect[0] == x && viewport_rect[1] == y && viewport_rect[2] == width && viewport_rect[3] == height)
+        return skipped();
+
+    glViewport(x, y, width, height);
+
+    viewport_rect[0] = x;
+    viewport_rect[1] = y;
+    viewport_rect[2] = width;
+    viewport_rect[3] = height;
+    viewport_known = true;
+
+    issued();
+}
+
+void gl_state::clear_color(float r, float g, float b, float a)
+{
+    if (clear_color_known && clear_rgba[0] == r && clear_rgba[1] == g && clear_rgba[2] == b && clear_rgba[3] == a)
+        return skipped();
+
+    glClearColor(r, g, b, a);
+
+    clear_rgba[0] = r;
+    clear_rgba[1] = g;
+    clear_rgba[2] = b;
+    clear_rgba[3] = a;
+    clear_color_known = true;
+
+    issued();
+}
+
+void gl_state::forget_program(unsigned int a_program)
+{
+    if (program == a_program)
+        program = unknown;
+}
+
+void gl_state::forget_vertex_array(unsigned int a_vertex_array)
+{
+    if (vertex_array == a_vertex_array)
+        vertex_array = unknown;
+}
+
+void gl_state::forget_buffer(unsigned int buffer)
+{
+    for (unsigned int &binding : buffers)
+    {
+        if (binding == buffer)
+            binding = unknown;
+    }
+}
+
+void gl_state::forget_framebuffer(unsigned int framebuffer)
+{
+    if (read_framebuffer == framebuffer)
+        read_framebuffer = unknown;
+
+    if (draw_framebuffer == framebuffer)
+        draw_framebuffer = unknown;
+}
+
+void gl_state::forget_renderbuffer(unsigned int a_renderbuffer)
+{
+    if (renderbuffer == a_renderbuffer)
+        renderbuffer = unknown;
+}
+
+void gl_state::forget_texture(unsigned int texture)
+{
+    for (unsigned int &binding : textures)
+    {
+        if (binding == texture)
+            binding = unknown;
+    }
+}
+
+void gl_state::invalidate()
+{
+    program = unknown;
+    vertex_array = unknown;
+
+    for (unsigned int &binding : buffers)
+        binding = unknown;
+
+    read_framebuffer = unknown;
+    draw_framebuffer = unknown;
+    renderbuffer = unknown;
+
+    active_unit = unknown;
+
+    for (unsigned int &binding : textures)
+        binding = unknown;
+
+    for (unsigned int &state : capability_states)
+        state = unknown;
+
+    viewport_known = false;
+    clear_color_known = false;
+}
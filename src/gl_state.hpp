@@ -0,0 +1,91 @@
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+// number of texture units whose 2D binding is tracked
+#define GL_STATE_TEXTURE_UNITS 16
+
+// number of enable/disable capabilities that can be tracked
+#define GL_STATE_CAPABILITIES 16
+
+// shadows the GL state the engine touches and drops calls that wouldn't change it.
+// every bind, enable and viewport change in the engine goes through here, one instance per context
+class gl_state
+{
+public:
+    // the state of the current context
+    static gl_state &get();
+
+    void use_program(unsigned int program);
+    void bind_vertex_array(unsigned int vertex_array);
+    void bind_buffer(GLenum target, unsigned int buffer);
+
+    // binds the indexed binding point, which also replaces the generic binding of the target
+    void bind_buffer_base(GLenum target, unsigned int index, unsigned int buffer);
+
+    // GL_FRAMEBUFFER binds both the read and the draw framebuffer
+    void bind_framebuffer(GLenum target, unsigned int framebuffer);
+    void bind_renderbuffer(unsigned int renderbuffer);
+
+    void active_texture(GLenum unit);
+    void bind_texture(GLenum target, unsigned int texture);
+
+    void enable(GLenum capability);
+    void disable(GLenum capability);
+
+    void viewport(int x, int y, int width, int height);
+    void clear_color(float r, float g, float b, float a);
+
+    // to drop cached bindings of a deleted object, GL may hand the name out again
+    void forget_program(unsigned int program);
+    void forget_vertex_array(unsigned int vertex_array);
+    void forget_buffer(unsigned int buffer);
+    void forget_framebuffer(unsigned int framebuffer);
+    void forget_renderbuffer(unsigned int renderbuffer);
+    void forget_texture(unsigned int texture);
+
+    // to forget everything, call after code outside the engine changed GL state
+    void invalidate();
+
+private:
+    gl_state() {invalidate();};
+
+    // to count a call as issued or skipped in the frame's render stats
+    static void issued();
+    static void skipped();
+
+    // to find the slot of a buffer target, -1 if it isn't tracked
+    static int buffer_slot(GLenum target);
+
+    // values that can't be a real binding, so the first call always goes through
+    static constexpr unsigned int unknown{0xFFFFFFFFu};
+
+    unsigned int program{unknown};
+    unsigned int vertex_array{unknown};
+
+    // array, element array, uniform, copy read, copy write, pixel pack, pixel unpack, texture
+    unsigned int buffers[8]{};
+
+    unsigned int read_framebuffer{unknown};
+    unsigned int draw_framebuffer{unknown};
+    unsigned int renderbuffer{unknown};
+
+    unsigned int active_unit{unknown};
+    unsigned int textures[GL_STATE_TEXTURE_UNITS]{};
+
+    // capability and 0 / 1 for disabled / enabled, unknown when not yet set
+    GLenum capabilities[GL_STATE_CAPABILITIES]{};
+    unsigned int capability_states[GL_STATE_CAPABILITIES]{};
+    int capability_count{};
+
+    int viewport_rect[4]{};
+    bool viewport_known{false};
+
+    float clear_rgba[4]{};
+    bool clear_color_known{false};
+};
+
+#endif //GL_STATE_H
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "gl_trace.hpp"
+
+gl_trace &gl_trace::get()
+{
+    static gl_trace trace{};
+    return trace;
+}
+
+void gl_trace::end_frame()
+{
+    for (gl_call_stats *stats : entries)
+    {
+        stats->total_calls += stats->calls;
+        stats->total_ns += stats->ns;
+        stats->total_bytes += stats->bytes;
+
+        stats->calls = 0;
+        stats->ns = 0;
+        stats->bytes = 0;
+    }
+}
+
+std::string gl_trace::frame_summary(std::size_t max_entries) const
+{
+    std::vector<const gl_call_stats *> called{};
+    std::uint64_t bytes{0};
+
+    for (const gl_call_stats *stats : entries)
+    {
+        if (stats->calls == 0)
+            continue;
+
+        called.push_back(stats);
+        bytes += stats->bytes;
+    }
+
+    std::sort(called.begin(), called.end(), [](const gl_call_stats *a, const gl_call_stats *b) {return a->calls > b->calls;});
+
+    std::string summary{};
+    for (std::size_t i = 0; i < std::min(max_entries, called.size()); i++)
+        summary += std::to_string(called[i]->calls) + " " + called[i]->name + ", ";
+
+    if (bytes >= 1024)
+        summary += std::to_string(bytes / 1024) + " KB uploaded";
+    else
+        summary += std::to_string(bytes) + " B uploaded";
+
+    return summary;
+}
+
+bool gl_trace::write_csv(const std::string &path) const
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cout << "ERROR::GL_TRACE::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file << "name,calls,ms,bytes\n";
+
+    for (const gl_call_stats *stats : entries)
+    {
+        if (stats->total_calls != 0)
+            file << stats->name << "," << stats->total_calls << "," << stats->total_ns / 1.0e6 << "," << stats->total_bytes << "\n";
+    }
+
+    return true;
+}
+
+void gl_trace::check_errors(const char *name)
+{
+    for (GLenum error = real_get_error(); error != GL_NO_ERROR; error = real_get_error())
+        std::cout << "ERROR::GL::" << name << ": 0x" << std::hex << error << std::dec << std::endl;
+}
+
+#ifdef OXIDIZER_GL_TRACE
+
+// bytes per pixel of client side texture data
+static std::uint64_t pixel_bytes(GLenum format, GLenum type)
+{
+    // packed types hold every component in one value
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE_3_3_2: case GL_UNSIGNED_BYTE_2_3_3_REV:
+        return 1;
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_5_6_5_REV:
+    case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+    case GL_UNSIGNED_SHORT_5_5_5_1: case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+        return 2;
+    case GL_UNSIGNED_INT_8_8_8_8: case GL_UNSIGNED_INT_8_8_8_8_REV:
+    case GL_UNSIGNED_INT_10_10_10_2: case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_5_9_9_9_REV:
+        return 4;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        return 8;
+    }
+
+    std::uint64_t components{1};
+    switch (format)
+    {
+    case GL_RG: case GL_RG_INTEGER: case GL_DEPTH_STENCIL:
+        components = 2; break;
+    case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER:
+        components = 3; break;
+    case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: case GL_BGRA_INTEGER:
+        components = 4; break;
+    }
+
+    switch (type)
+    {
+    case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT:
+        return components * 2;
+    case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT:
+        return components * 4;
+    }
+
+    return components;
+}
+
+// bytes an entry point reads from client memory, zero for every call that isn't an upload.
+// a null data pointer only allocates, and data read from a bound unpack buffer isn't counted
+template <auto slot>
+struct upload_size
+{
+    template <typename... Args>
+    static std::uint64_t of(Args...) {return 0;};
+};
+
+template <>
+struct upload_size<&glad_glBufferData>
+{
+    static std::uint64_t of(GLenum, GLsizeiptr size, const void *data, GLenum) {return data ? size : 0;};
+};
+
+template <>
+struct upload_size<&glad_glBufferSubData>
+{
+    static std::uint64_t of(GLenum, GLintptr, GLsizeiptr size, const void *data) {return data ? size : 0;};
+};
+
+template <>
+struct upload_size<&glad_glTexImage2D>
+{
+    static std::uint64_t of(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void *data)
+    {
+        return data ? (std::uint64_t)width * height * pixel_bytes(format, type) : 0;
+    };
+};
+
+template <>
+struct upload_size<&glad_glTexSubImage2D>
+{
+    static std::uint64_t of(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *data)
+    {
+        return data ? (std::uint64_t)width * height * pixel_bytes(format, type) : 0;
+    };
+};
+
+template <>
+struct upload_size<&glad_glTexImage3D>
+{
+    static std::uint64_t of(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format, GLenum type, const void *data)
+    {
+        return data ? (std::uint64_t)width * height * depth * pixel_bytes(format, type) : 0;
+    };
+};
+
+template <>
+struct upload_size<&glad_glTexSubImage3D>
+{
+    static std::uint64_t of(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *data)
+    {
+        return data ? (std::uint64_t)width * height * depth * pixel_bytes(format, type) : 0;
+    };
+};
+
+// replaces one of glad's function pointers with a wrapper that forwards to the driver
+template <typename F, F *slot>
+struct gl_hook;
+
+template <typename R, typename... Args, R (APIENTRYP *slot)(Args...)>
+struct gl_hook<R (APIENTRYP)(Args...), slot>
+{
+    static inline R (APIENTRYP real)(Args...){};
+    static inline gl_call_stats stats{};
+    static inline bool check_errors{true};
+
+    static R APIENTRY call(Args... args)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        if constexpr (std::is_void_v<R>)
+        {
+            real(args...);
+            finish(start, args...);
+        }
+        else
+        {
+            R result = real(args...);
+            finish(start, args...);
+            return result;
+        }
+    };
+
+    static void finish(std::chrono::steady_clock::time_point start, Args... args)
+    {
+        stats.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        stats.calls++;
+        stats.bytes += upload_size<slot>::of(args...);
+
+#ifndef NDEBUG
+        if (check_errors)
+            gl_trace::get().check_errors(stats.name);
+#endif
+    };
+
+    static void install(const char *name)
+    {
+        // entry points the context doesn't have stay null
+        if (*slot == nullptr)
+            return;
+
+        real = *slot;
+        *slot = &call;
+
+        stats.name = name;
+        check_errors = std::strcmp(name, "glGetError") != 0;
+
+        gl_trace::get().add(&stats);
+    };
+};
+
+bool gl_trace::install()
+{
+    if (installed)
+        return true;
+
+    real_get_error = glad_glGetError;
+
+#define GL_TRACE_FUNCTION(name) gl_hook<decltype(glad_##name), &glad_##name>::install(#name);
+#include "gl_trace_functions.inl"
+#undef GL_TRACE_FUNCTION
+
+    installed = true;
+
+    return true;
+}
+
+#else
+
+bool gl_trace::install()
+{
+    return false;
+}
+
+#endif //OXIDIZER_GL_TRACE
@@ -0,0 +1,67 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+// what one GL entry point did this frame and since tracing started
+struct gl_call_stats
+{
+    const char *name{};
+
+    // this frame
+    std::uint64_t calls{};
+    std::uint64_t ns{};
+
+    // bytes read from client memory by buffer and texture uploads
+    std::uint64_t bytes{};
+
+    // every finished frame
+    std::uint64_t total_calls{};
+    std::uint64_t total_ns{};
+    std::uint64_t total_bytes{};
+};
+
+// counts, times and sizes every GL call by wrapping glad's function pointers.
+// only built in with OXIDIZER_GL_TRACE, otherwise install does nothing and calls go straight to the driver.
+// builds without NDEBUG also check glGetError after every traced call
+class gl_trace
+{
+public:
+    static gl_trace &get();
+
+    // to wrap every loaded entry point, once glad has loaded them. returns false when compiled out
+    bool install();
+
+    bool is_installed() const {return installed;};
+
+    // to fold this frame's counts into the totals and start counting the next frame
+    void end_frame();
+
+    // to summarize this frame's busiest entry points, like "412 glUniform3fv, 3 glBufferData, 8 KB uploaded"
+    std::string frame_summary(std::size_t max_entries = 8) const;
+
+    // to write the totals of every entry point that was called, as name,calls,ms,bytes
+    bool write_csv(const std::string &path) const;
+
+    // to register a wrapped entry point
+    void add(gl_call_stats *stats) {entries.push_back(stats);};
+
+    // to report every pending GL error, blaming the entry point just called
+    void check_errors(const char *name);
+
+private:
+    gl_trace() = default;
+
+    std::vector<gl_call_stats *> entries{};
+
+    // the driver's glGetError, since the wrapped one would report itself
+    PFNGLGETERRORPROC real_get_error{};
+
+    bool installed{false};
+};
+
+#endif //GL_TRACE_H
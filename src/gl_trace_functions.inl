@@ -0,0 +1,1050 @@
+// every entry point glad loads, regenerate with:
+// grep -oE "^GLAPI PFN\w+PROC glad_gl\w+;" include/glad/glad.h | sed -E "s/.*glad_(gl\w+);/GL_TRACE_FUNCTION(\1)/"
+GL_TRACE_FUNCTION(glCullFace)
+GL_TRACE_FUNCTION(glFrontFace)
+GL_TRACE_FUNCTION(glHint)
+GL_TRACE_FUNCTION(glLineWidth)
+GL_TRACE_FUNCTION(glPointSize)
+GL_TRACE_FUNCTION(glPolygonMode)
+GL_TRACE_FUNCTION(glScissor)
+GL_TRACE_FUNCTION(glTexParameterf)
+GL_TRACE_FUNCTION(glTexParameterfv)
+GL_TRACE_FUNCTION(glTexParameteri)
+GL_TRACE_FUNCTION(glTexParameteriv)
+GL_TRACE_FUNCTION(glTexImage1D)
+GL_TRACE_FUNCTION(glTexImage2D)
+GL_TRACE_FUNCTION(glDrawBuffer)
+GL_TRACE_FUNCTION(glClear)
+GL_TRACE_FUNCTION(glClearColor)
+GL_TRACE_FUNCTION(glClearStencil)
+GL_TRACE_FUNCTION(glClearDepth)
+GL_TRACE_FUNCTION(glStencilMask)
+GL_TRACE_FUNCTION(glColorMask)
+GL_TRACE_FUNCTION(glDepthMask)
+GL_TRACE_FUNCTION(glDisable)
+GL_TRACE_FUNCTION(glEnable)
+GL_TRACE_FUNCTION(glFinish)
+GL_TRACE_FUNCTION(glFlush)
+GL_TRACE_FUNCTION(glBlendFunc)
+GL_TRACE_FUNCTION(glLogicOp)
+GL_TRACE_FUNCTION(glStencilFunc)
+GL_TRACE_FUNCTION(glStencilOp)
+GL_TRACE_FUNCTION(glDepthFunc)
+GL_TRACE_FUNCTION(glPixelStoref)
+GL_TRACE_FUNCTION(glPixelStorei)
+GL_TRACE_FUNCTION(glReadBuffer)
+GL_TRACE_FUNCTION(glReadPixels)
+GL_TRACE_FUNCTION(glGetBooleanv)
+GL_TRACE_FUNCTION(glGetDoublev)
+GL_TRACE_FUNCTION(glGetError)
+GL_TRACE_FUNCTION(glGetFloatv)
+GL_TRACE_FUNCTION(glGetIntegerv)
+GL_TRACE_FUNCTION(glGetString)
+GL_TRACE_FUNCTION(glGetTexImage)
+GL_TRACE_FUNCTION(glGetTexParameterfv)
+GL_TRACE_FUNCTION(glGetTexParameteriv)
+GL_TRACE_FUNCTION(glGetTexLevelParameterfv)
+GL_TRACE_FUNCTION(glGetTexLevelParameteriv)
+GL_TRACE_FUNCTION(glIsEnabled)
+GL_TRACE_FUNCTION(glDepthRange)
+GL_TRACE_FUNCTION(glViewport)
+GL_TRACE_FUNCTION(glNewList)
+GL_TRACE_FUNCTION(glEndList)
+GL_TRACE_FUNCTION(glCallList)
+GL_TRACE_FUNCTION(glCallLists)
+GL_TRACE_FUNCTION(glDeleteLists)
+GL_TRACE_FUNCTION(glGenLists)
+GL_TRACE_FUNCTION(glListBase)
+GL_TRACE_FUNCTION(glBegin)
+GL_TRACE_FUNCTION(glBitmap)
+GL_TRACE_FUNCTION(glColor3b)
+GL_TRACE_FUNCTION(glColor3bv)
+GL_TRACE_FUNCTION(glColor3d)
+GL_TRACE_FUNCTION(glColor3dv)
+GL_TRACE_FUNCTION(glColor3f)
+GL_TRACE_FUNCTION(glColor3fv)
+GL_TRACE_FUNCTION(glColor3i)
+GL_TRACE_FUNCTION(glColor3iv)
+GL_TRACE_FUNCTION(glColor3s)
+GL_TRACE_FUNCTION(glColor3sv)
+GL_TRACE_FUNCTION(glColor3ub)
+GL_TRACE_FUNCTION(glColor3ubv)
+GL_TRACE_FUNCTION(glColor3ui)
+GL_TRACE_FUNCTION(glColor3uiv)
+GL_TRACE_FUNCTION(glColor3us)
+GL_TRACE_FUNCTION(glColor3usv)
+GL_TRACE_FUNCTION(glColor4b)
+GL_TRACE_FUNCTION(glColor4bv)
+GL_TRACE_FUNCTION(glColor4d)
+GL_TRACE_FUNCTION(glColor4dv)
+GL_TRACE_FUNCTION(glColor4f)
+GL_TRACE_FUNCTION(glColor4fv)
+GL_TRACE_FUNCTION(glColor4i)
+GL_TRACE_FUNCTION(glColor4iv)
+GL_TRACE_FUNCTION(glColor4s)
+GL_TRACE_FUNCTION(glColor4sv)
+GL_TRACE_FUNCTION(glColor4ub)
+GL_TRACE_FUNCTION(glColor4ubv)
+GL_TRACE_FUNCTION(glColor4ui)
+GL_TRACE_FUNCTION(glColor4uiv)
+GL_TRACE_FUNCTION(glColor4us)
+GL_TRACE_FUNCTION(glColor4usv)
+GL_TRACE_FUNCTION(glEdgeFlag)
+GL_TRACE_FUNCTION(glEdgeFlagv)
+GL_TRACE_FUNCTION(glEnd)
+GL_TRACE_FUNCTION(glIndexd)
+GL_TRACE_FUNCTION(glIndexdv)
+GL_TRACE_FUNCTION(glIndexf)
+GL_TRACE_FUNCTION(glIndexfv)
+GL_TRACE_FUNCTION(glIndexi)
+GL_TRACE_FUNCTION(glIndexiv)
+GL_TRACE_FUNCTION(glIndexs)
+GL_TRACE_FUNCTION(glIndexsv)
+GL_TRACE_FUNCTION(glNormal3b)
+GL_TRACE_FUNCTION(glNormal3bv)
+GL_TRACE_FUNCTION(glNormal3d)
+GL_TRACE_FUNCTION(glNormal3dv)
+GL_TRACE_FUNCTION(glNormal3f)
+GL_TRACE_FUNCTION(glNormal3fv)
+GL_TRACE_FUNCTION(glNormal3i)
+GL_TRACE_FUNCTION(glNormal3iv)
+GL_TRACE_FUNCTION(glNormal3s)
+GL_TRACE_FUNCTION(glNormal3sv)
+GL_TRACE_FUNCTION(glRasterPos2d)
+GL_TRACE_FUNCTION(glRasterPos2dv)
+GL_TRACE_FUNCTION(glRasterPos2f)
+GL_TRACE_FUNCTION(glRasterPos2fv)
+GL_TRACE_FUNCTION(glRasterPos2i)
+GL_TRACE_FUNCTION(glRasterPos2iv)
+GL_TRACE_FUNCTION(glRasterPos2s)
+GL_TRACE_FUNCTION(glRasterPos2sv)
+GL_TRACE_FUNCTION(glRasterPos3d)
+GL_TRACE_FUNCTION(glRasterPos3dv)
+GL_TRACE_FUNCTION(glRasterPos3f)
+GL_TRACE_FUNCTION(glRasterPos3fv)
+GL_TRACE_FUNCTION(glRasterPos3i)
+GL_TRACE_FUNCTION(glRasterPos3iv)
+GL_TRACE_FUNCTION(glRasterPos3s)
+GL_TRACE_FUNCTION(glRasterPos3sv)
+GL_TRACE_FUNCTION(glRasterPos4d)
+GL_TRACE_FUNCTION(glRasterPos4dv)
+GL_TRACE_FUNCTION(glRasterPos4f)
+GL_TRACE_FUNCTION(glRasterPos4fv)
+GL_TRACE_FUNCTION(glRasterPos4i)
+GL_TRACE_FUNCTION(glRasterPos4iv)
+GL_TRACE_FUNCTION(glRasterPos4s)
+GL_TRACE_FUNCTION(glRasterPos4sv)
+GL_TRACE_FUNCTION(glRectd)
+GL_TRACE_FUNCTION(glRectdv)
+GL_TRACE_FUNCTION(glRectf)
+GL_TRACE_FUNCTION(glRectfv)
+GL_TRACE_FUNCTION(glRecti)
+GL_TRACE_FUNCTION(glRectiv)
+GL_TRACE_FUNCTION(glRects)
+GL_TRACE_FUNCTION(glRectsv)
+GL_TRACE_FUNCTION(glTexCoord1d)
+GL_TRACE_FUNCTION(glTexCoord1dv)
+GL_TRACE_FUNCTION(glTexCoord1f)
+GL_TRACE_FUNCTION(glTexCoord1fv)
+GL_TRACE_FUNCTION(glTexCoord1i)
+GL_TRACE_FUNCTION(glTexCoord1iv)
+GL_TRACE_FUNCTION(glTexCoord1s)
+GL_TRACE_FUNCTION(glTexCoord1sv)
+GL_TRACE_FUNCTION(glTexCoord2d)
+GL_TRACE_FUNCTION(glTexCoord2dv)
+GL_TRACE_FUNCTION(glTexCoord2f)
+GL_TRACE_FUNCTION(glTexCoord2fv)
+GL_TRACE_FUNCTION(glTexCoord2i)
+GL_TRACE_FUNCTION(glTexCoord2iv)
+GL_TRACE_FUNCTION(glTexCoord2s)
+GL_TRACE_FUNCTION(glTexCoord2sv)
+GL_TRACE_FUNCTION(glTexCoord3d)
+GL_TRACE_FUNCTION(glTexCoord3dv)
+GL_TRACE_FUNCTION(glTexCoord3f)
+GL_TRACE_FUNCTION(glTexCoord3fv)
+GL_TRACE_FUNCTION(glTexCoord3i)
+GL_TRACE_FUNCTION(glTexCoord3iv)
+GL_TRACE_FUNCTION(glTexCoord3s)
+GL_TRACE_FUNCTION(glTexCoord3sv)
+GL_TRACE_FUNCTION(glTexCoord4d)
+GL_TRACE_FUNCTION(glTexCoord4dv)
+GL_TRACE_FUNCTION(glTexCoord4f)
+GL_TRACE_FUNCTION(glTexCoord4fv)
+GL_TRACE_FUNCTION(glTexCoord4i)
+GL_TRACE_FUNCTION(glTexCoord4iv)
+GL_TRACE_FUNCTION(glTexCoord4s)
+GL_TRACE_FUNCTION(glTexCoord4sv)
+GL_TRACE_FUNCTION(glVertex2d)
+GL_TRACE_FUNCTION(glVertex2dv)
+GL_TRACE_FUNCTION(glVertex2f)
+GL_TRACE_FUNCTION(glVertex2fv)
+GL_TRACE_FUNCTION(glVertex2i)
+GL_TRACE_FUNCTION(glVertex2iv)
+GL_TRACE_FUNCTION(glVertex2s)
+GL_TRACE_FUNCTION(glVertex2sv)
+GL_TRACE_FUNCTION(glVertex3d)
+GL_TRACE_FUNCTION(glVertex3dv)
+GL_TRACE_FUNCTION(glVertex3f)
+GL_TRACE_FUNCTION(glVertex3fv)
+GL_TRACE_FUNCTION(glVertex3i)
+GL_TRACE_FUNCTION(glVertex3iv)
+GL_TRACE_FUNCTION(glVertex3s)
+GL_TRACE_FUNCTION(glVertex3sv)
+GL_TRACE_FUNCTION(glVertex4d)
+GL_TRACE_FUNCTION(glVertex4dv)
+GL_TRACE_FUNCTION(glVertex4f)
+GL_TRACE_FUNCTION(glVertex4fv)
+GL_TRACE_FUNCTION(glVertex4i)
+GL_TRACE_FUNCTION(glVertex4iv)
+GL_TRACE_FUNCTION(glVertex4s)
+GL_TRACE_FUNCTION(glVertex4sv)
+GL_TRACE_FUNCTION(glClipPlane)
+GL_TRACE_FUNCTION(glColorMaterial)
+GL_TRACE_FUNCTION(glFogf)
+GL_TRACE_FUNCTION(glFogfv)
+GL_TRACE_FUNCTION(glFogi)
+GL_TRACE_FUNCTION(glFogiv)
+GL_TRACE_FUNCTION(glLightf)
+GL_TRACE_FUNCTION(glLightfv)
+GL_TRACE_FUNCTION(glLighti)
+GL_TRACE_FUNCTION(glLightiv)
+GL_TRACE_FUNCTION(glLightModelf)
+GL_TRACE_FUNCTION(glLightModelfv)
+GL_TRACE_FUNCTION(glLightModeli)
+GL_TRACE_FUNCTION(glLightModeliv)
+GL_TRACE_FUNCTION(glLineStipple)
+GL_TRACE_FUNCTION(glMaterialf)
+GL_TRACE_FUNCTION(glMaterialfv)
+GL_TRACE_FUNCTION(glMateriali)
+GL_TRACE_FUNCTION(glMaterialiv)
+GL_TRACE_FUNCTION(glPolygonStipple)
+GL_TRACE_FUNCTION(glShadeModel)
+GL_TRACE_FUNCTION(glTexEnvf)
+GL_TRACE_FUNCTION(glTexEnvfv)
+GL_TRACE_FUNCTION(glTexEnvi)
+GL_TRACE_FUNCTION(glTexEnviv)
+GL_TRACE_FUNCTION(glTexGend)
+GL_TRACE_FUNCTION(glTexGendv)
+GL_TRACE_FUNCTION(glTexGenf)
+GL_TRACE_FUNCTION(glTexGenfv)
+GL_TRACE_FUNCTION(glTexGeni)
+GL_TRACE_FUNCTION(glTexGeniv)
+GL_TRACE_FUNCTION(glFeedbackBuffer)
+GL_TRACE_FUNCTION(glSelectBuffer)
+GL_TRACE_FUNCTION(glRenderMode)
+GL_TRACE_FUNCTION(glInitNames)
+GL_TRACE_FUNCTION(glLoadName)
+GL_TRACE_FUNCTION(glPassThrough)
+GL_TRACE_FUNCTION(glPopName)
+GL_TRACE_FUNCTION(glPushName)
+GL_TRACE_FUNCTION(glClearAccum)
+GL_TRACE_FUNCTION(glClearIndex)
+GL_TRACE_FUNCTION(glIndexMask)
+GL_TRACE_FUNCTION(glAccum)
+GL_TRACE_FUNCTION(glPopAttrib)
+GL_TRACE_FUNCTION(glPushAttrib)
+GL_TRACE_FUNCTION(glMap1d)
+GL_TRACE_FUNCTION(glMap1f)
+GL_TRACE_FUNCTION(glMap2d)
+GL_TRACE_FUNCTION(glMap2f)
+GL_TRACE_FUNCTION(glMapGrid1d)
+GL_TRACE_FUNCTION(glMapGrid1f)
+GL_TRACE_FUNCTION(glMapGrid2d)
+GL_TRACE_FUNCTION(glMapGrid2f)
+GL_TRACE_FUNCTION(glEvalCoord1d)
+GL_TRACE_FUNCTION(glEvalCoord1dv)
+GL_TRACE_FUNCTION(glEvalCoord1f)
+GL_TRACE_FUNCTION(glEvalCoord1fv)
+GL_TRACE_FUNCTION(glEvalCoord2d)
+GL_TRACE_FUNCTION(glEvalCoord2dv)
+GL_TRACE_FUNCTION(glEvalCoord2f)
+GL_TRACE_FUNCTION(glEvalCoord2fv)
+GL_TRACE_FUNCTION(glEvalMesh1)
+GL_TRACE_FUNCTION(glEvalPoint1)
+GL_TRACE_FUNCTION(glEvalMesh2)
+GL_TRACE_FUNCTION(glEvalPoint2)
+GL_TRACE_FUNCTION(glAlphaFunc)
+GL_TRACE_FUNCTION(glPixelZoom)
+GL_TRACE_FUNCTION(glPixelTransferf)
+GL_TRACE_FUNCTION(glPixelTransferi)
+GL_TRACE_FUNCTION(glPixelMapfv)
+GL_TRACE_FUNCTION(glPixelMapuiv)
+GL_TRACE_FUNCTION(glPixelMapusv)
+GL_TRACE_FUNCTION(glCopyPixels)
+GL_TRACE_FUNCTION(glDrawPixels)
+GL_TRACE_FUNCTION(glGetClipPlane)
+GL_TRACE_FUNCTION(glGetLightfv)
+GL_TRACE_FUNCTION(glGetLightiv)
+GL_TRACE_FUNCTION(glGetMapdv)
+GL_TRACE_FUNCTION(glGetMapfv)
+GL_TRACE_FUNCTION(glGetMapiv)
+GL_TRACE_FUNCTION(glGetMaterialfv)
+GL_TRACE_FUNCTION(glGetMaterialiv)
+GL_TRACE_FUNCTION(glGetPixelMapfv)
+GL_TRACE_FUNCTION(glGetPixelMapuiv)
+GL_TRACE_FUNCTION(glGetPixelMapusv)
+GL_TRACE_FUNCTION(glGetPolygonStipple)
+GL_TRACE_FUNCTION(glGetTexEnvfv)
+GL_TRACE_FUNCTION(glGetTexEnviv)
+GL_TRACE_FUNCTION(glGetTexGendv)
+GL_TRACE_FUNCTION(glGetTexGenfv)
+GL_TRACE_FUNCTION(glGetTexGeniv)
+GL_TRACE_FUNCTION(glIsList)
+GL_TRACE_FUNCTION(glFrustum)
+GL_TRACE_FUNCTION(glLoadIdentity)
+GL_TRACE_FUNCTION(glLoadMatrixf)
+GL_TRACE_FUNCTION(glLoadMatrixd)
+GL_TRACE_FUNCTION(glMatrixMode)
+GL_TRACE_FUNCTION(glMultMatrixf)
+GL_TRACE_FUNCTION(glMultMatrixd)
+GL_TRACE_FUNCTION(glOrtho)
+GL_TRACE_FUNCTION(glPopMatrix)
+GL_TRACE_FUNCTION(glPushMatrix)
+GL_TRACE_FUNCTION(glRotated)
+GL_TRACE_FUNCTION(glRotatef)
+GL_TRACE_FUNCTION(glScaled)
+GL_TRACE_FUNCTION(glScalef)
+GL_TRACE_FUNCTION(glTranslated)
+GL_TRACE_FUNCTION(glTranslatef)
+GL_TRACE_FUNCTION(glDrawArrays)
+GL_TRACE_FUNCTION(glDrawElements)
+GL_TRACE_FUNCTION(glGetPointerv)
+GL_TRACE_FUNCTION(glPolygonOffset)
+GL_TRACE_FUNCTION(glCopyTexImage1D)
+GL_TRACE_FUNCTION(glCopyTexImage2D)
+GL_TRACE_FUNCTION(glCopyTexSubImage1D)
+GL_TRACE_FUNCTION(glCopyTexSubImage2D)
+GL_TRACE_FUNCTION(glTexSubImage1D)
+GL_TRACE_FUNCTION(glTexSubImage2D)
+GL_TRACE_FUNCTION(glBindTexture)
+GL_TRACE_FUNCTION(glDeleteTextures)
+GL_TRACE_FUNCTION(glGenTextures)
+GL_TRACE_FUNCTION(glIsTexture)
+GL_TRACE_FUNCTION(glArrayElement)
+GL_TRACE_FUNCTION(glColorPointer)
+GL_TRACE_FUNCTION(glDisableClientState)
+GL_TRACE_FUNCTION(glEdgeFlagPointer)
+GL_TRACE_FUNCTION(glEnableClientState)
+GL_TRACE_FUNCTION(glIndexPointer)
+GL_TRACE_FUNCTION(glInterleavedArrays)
+GL_TRACE_FUNCTION(glNormalPointer)
+GL_TRACE_FUNCTION(glTexCoordPointer)
+GL_TRACE_FUNCTION(glVertexPointer)
+GL_TRACE_FUNCTION(glAreTexturesResident)
+GL_TRACE_FUNCTION(glPrioritizeTextures)
+GL_TRACE_FUNCTION(glIndexub)
+GL_TRACE_FUNCTION(glIndexubv)
+GL_TRACE_FUNCTION(glPopClientAttrib)
+GL_TRACE_FUNCTION(glPushClientAttrib)
+GL_TRACE_FUNCTION(glDrawRangeElements)
+GL_TRACE_FUNCTION(glTexImage3D)
+GL_TRACE_FUNCTION(glTexSubImage3D)
+GL_TRACE_FUNCTION(glCopyTexSubImage3D)
+GL_TRACE_FUNCTION(glActiveTexture)
+GL_TRACE_FUNCTION(glSampleCoverage)
+GL_TRACE_FUNCTION(glCompressedTexImage3D)
+GL_TRACE_FUNCTION(glCompressedTexImage2D)
+GL_TRACE_FUNCTION(glCompressedTexImage1D)
+GL_TRACE_FUNCTION(glCompressedTexSubImage3D)
+GL_TRACE_FUNCTION(glCompressedTexSubImage2D)
+GL_TRACE_FUNCTION(glCompressedTexSubImage1D)
+GL_TRACE_FUNCTION(glGetCompressedTexImage)
+GL_TRACE_FUNCTION(glClientActiveTexture)
+GL_TRACE_FUNCTION(glMultiTexCoord1d)
+GL_TRACE_FUNCTION(glMultiTexCoord1dv)
+GL_TRACE_FUNCTION(glMultiTexCoord1f)
+GL_TRACE_FUNCTION(glMultiTexCoord1fv)
+GL_TRACE_FUNCTION(glMultiTexCoord1i)
+GL_TRACE_FUNCTION(glMultiTexCoord1iv)
+GL_TRACE_FUNCTION(glMultiTexCoord1s)
+GL_TRACE_FUNCTION(glMultiTexCoord1sv)
+GL_TRACE_FUNCTION(glMultiTexCoord2d)
+GL_TRACE_FUNCTION(glMultiTexCoord2dv)
+GL_TRACE_FUNCTION(glMultiTexCoord2f)
+GL_TRACE_FUNCTION(glMultiTexCoord2fv)
+GL_TRACE_FUNCTION(glMultiTexCoord2i)
+GL_TRACE_FUNCTION(glMultiTexCoord2iv)
+GL_TRACE_FUNCTION(glMultiTexCoord2s)
+GL_TRACE_FUNCTION(glMultiTexCoord2sv)
+GL_TRACE_FUNCTION(glMultiTexCoord3d)
+GL_TRACE_FUNCTION(glMultiTexCoord3dv)
+GL_TRACE_FUNCTION(glMultiTexCoord3f)
+GL_TRACE_FUNCTION(glMultiTexCoord3fv)
+GL_TRACE_FUNCTION(glMultiTexCoord3i)
+GL_TRACE_FUNCTION(glMultiTexCoord3iv)
+GL_TRACE_FUNCTION(glMultiTexCoord3s)
+GL_TRACE_FUNCTION(glMultiTexCoord3sv)
+GL_TRACE_FUNCTION(glMultiTexCoord4d)
+GL_TRACE_FUNCTION(glMultiTexCoord4dv)
+GL_TRACE_FUNCTION(glMultiTexCoord4f)
+GL_TRACE_FUNCTION(glMultiTexCoord4fv)
+GL_TRACE_FUNCTION(glMultiTexCoord4i)
+GL_TRACE_FUNCTION(glMultiTexCoord4iv)
+GL_TRACE_FUNCTION(glMultiTexCoord4s)
+GL_TRACE_FUNCTION(glMultiTexCoord4sv)
+GL_TRACE_FUNCTION(glLoadTransposeMatrixf)
+GL_TRACE_FUNCTION(glLoadTransposeMatrixd)
+GL_TRACE_FUNCTION(glMultTransposeMatrixf)
+GL_TRACE_FUNCTION(glMultTransposeMatrixd)
+GL_TRACE_FUNCTION(glBlendFuncSeparate)
+GL_TRACE_FUNCTION(glMultiDrawArrays)
+GL_TRACE_FUNCTION(glMultiDrawElements)
+GL_TRACE_FUNCTION(glPointParameterf)
+GL_TRACE_FUNCTION(glPointParameterfv)
+GL_TRACE_FUNCTION(glPointParameteri)
+GL_TRACE_FUNCTION(glPointParameteriv)
+GL_TRACE_FUNCTION(glFogCoordf)
+GL_TRACE_FUNCTION(glFogCoordfv)
+GL_TRACE_FUNCTION(glFogCoordd)
+GL_TRACE_FUNCTION(glFogCoorddv)
+GL_TRACE_FUNCTION(glFogCoordPointer)
+GL_TRACE_FUNCTION(glSecondaryColor3b)
+GL_TRACE_FUNCTION(glSecondaryColor3bv)
+GL_TRACE_FUNCTION(glSecondaryColor3d)
+GL_TRACE_FUNCTION(glSecondaryColor3dv)
+GL_TRACE_FUNCTION(glSecondaryColor3f)
+GL_TRACE_FUNCTION(glSecondaryColor3fv)
+GL_TRACE_FUNCTION(glSecondaryColor3i)
+GL_TRACE_FUNCTION(glSecondaryColor3iv)
+GL_TRACE_FUNCTION(glSecondaryColor3s)
+GL_TRACE_FUNCTION(glSecondaryColor3sv)
+GL_TRACE_FUNCTION(glSecondaryColor3ub)
+GL_TRACE_FUNCTION(glSecondaryColor3ubv)
+GL_TRACE_FUNCTION(glSecondaryColor3ui)
+GL_TRACE_FUNCTION(glSecondaryColor3uiv)
+GL_TRACE_FUNCTION(glSecondaryColor3us)
+GL_TRACE_FUNCTION(glSecondaryColor3usv)
+GL_TRACE_FUNCTION(glSecondaryColorPointer)
+GL_TRACE_FUNCTION(glWindowPos2d)
+GL_TRACE_FUNCTION(glWindowPos2dv)
+GL_TRACE_FUNCTION(glWindowPos2f)
+GL_TRACE_FUNCTION(glWindowPos2fv)
+GL_TRACE_FUNCTION(glWindowPos2i)
+GL_TRACE_FUNCTION(glWindowPos2iv)
+GL_TRACE_FUNCTION(glWindowPos2s)
+GL_TRACE_FUNCTION(glWindowPos2sv)
+GL_TRACE_FUNCTION(glWindowPos3d)
+GL_TRACE_FUNCTION(glWindowPos3dv)
+GL_TRACE_FUNCTION(glWindowPos3f)
+GL_TRACE_FUNCTION(glWindowPos3fv)
+GL_TRACE_FUNCTION(glWindowPos3i)
+GL_TRACE_FUNCTION(glWindowPos3iv)
+GL_TRACE_FUNCTION(glWindowPos3s)
+GL_TRACE_FUNCTION(glWindowPos3sv)
+GL_TRACE_FUNCTION(glBlendColor)
+GL_TRACE_FUNCTION(glBlendEquation)
+GL_TRACE_FUNCTION(glGenQueries)
+GL_TRACE_FUNCTION(glDeleteQueries)
+GL_TRACE_FUNCTION(glIsQuery)
+GL_TRACE_FUNCTION(glBeginQuery)
+GL_TRACE_FUNCTION(glEndQuery)
+GL_TRACE_FUNCTION(glGetQueryiv)
+GL_TRACE_FUNCTION(glGetQueryObjectiv)
+GL_TRACE_FUNCTION(glGetQueryObjectuiv)
+GL_TRACE_FUNCTION(glBindBuffer)
+GL_TRACE_FUNCTION(glDeleteBuffers)
+GL_TRACE_FUNCTION(glGenBuffers)
+GL_TRACE_FUNCTION(glIsBuffer)
+GL_TRACE_FUNCTION(glBufferData)
+GL_TRACE_FUNCTION(glBufferSubData)
+GL_TRACE_FUNCTION(glGetBufferSubData)
+GL_TRACE_FUNCTION(glMapBuffer)
+GL_TRACE_FUNCTION(glUnmapBuffer)
+GL_TRACE_FUNCTION(glGetBufferParameteriv)
+GL_TRACE_FUNCTION(glGetBufferPointerv)
+GL_TRACE_FUNCTION(glBlendEquationSeparate)
+GL_TRACE_FUNCTION(glDrawBuffers)
+GL_TRACE_FUNCTION(glStencilOpSeparate)
+GL_TRACE_FUNCTION(glStencilFuncSeparate)
+GL_TRACE_FUNCTION(glStencilMaskSeparate)
+GL_TRACE_FUNCTION(glAttachShader)
+GL_TRACE_FUNCTION(glBindAttribLocation)
+GL_TRACE_FUNCTION(glCompileShader)
+GL_TRACE_FUNCTION(glCreateProgram)
+GL_TRACE_FUNCTION(glCreateShader)
+GL_TRACE_FUNCTION(glDeleteProgram)
+GL_TRACE_FUNCTION(glDeleteShader)
+GL_TRACE_FUNCTION(glDetachShader)
+GL_TRACE_FUNCTION(glDisableVertexAttribArray)
+GL_TRACE_FUNCTION(glEnableVertexAttribArray)
+GL_TRACE_FUNCTION(glGetActiveAttrib)
+GL_TRACE_FUNCTION(glGetActiveUniform)
+GL_TRACE_FUNCTION(glGetAttachedShaders)
+GL_TRACE_FUNCTION(glGetAttribLocation)
+GL_TRACE_FUNCTION(glGetProgramiv)
+GL_TRACE_FUNCTION(glGetProgramInfoLog)
+GL_TRACE_FUNCTION(glGetShaderiv)
+GL_TRACE_FUNCTION(glGetShaderInfoLog)
+GL_TRACE_FUNCTION(glGetShaderSource)
+GL_TRACE_FUNCTION(glGetUniformLocation)
+GL_TRACE_FUNCTION(glGetUniformfv)
+GL_TRACE_FUNCTION(glGetUniformiv)
+GL_TRACE_FUNCTION(glGetVertexAttribdv)
+GL_TRACE_FUNCTION(glGetVertexAttribfv)
+GL_TRACE_FUNCTION(glGetVertexAttribiv)
+GL_TRACE_FUNCTION(glGetVertexAttribPointerv)
+GL_TRACE_FUNCTION(glIsProgram)
+GL_TRACE_FUNCTION(glIsShader)
+GL_TRACE_FUNCTION(glLinkProgram)
+GL_TRACE_FUNCTION(glShaderSource)
+GL_TRACE_FUNCTION(glUseProgram)
+GL_TRACE_FUNCTION(glUniform1f)
+GL_TRACE_FUNCTION(glUniform2f)
+GL_TRACE_FUNCTION(glUniform3f)
+GL_TRACE_FUNCTION(glUniform4f)
+GL_TRACE_FUNCTION(glUniform1i)
+GL_TRACE_FUNCTION(glUniform2i)
+GL_TRACE_FUNCTION(glUniform3i)
+GL_TRACE_FUNCTION(glUniform4i)
+GL_TRACE_FUNCTION(glUniform1fv)
+GL_TRACE_FUNCTION(glUniform2fv)
+GL_TRACE_FUNCTION(glUniform3fv)
+GL_TRACE_FUNCTION(glUniform4fv)
+GL_TRACE_FUNCTION(glUniform1iv)
+GL_TRACE_FUNCTION(glUniform2iv)
+GL_TRACE_FUNCTION(glUniform3iv)
+GL_TRACE_FUNCTION(glUniform4iv)
+GL_TRACE_FUNCTION(glUniformMatrix2fv)
+GL_TRACE_FUNCTION(glUniformMatrix3fv)
+GL_TRACE_FUNCTION(glUniformMatrix4fv)
+GL_TRACE_FUNCTION(glValidateProgram)
+GL_TRACE_FUNCTION(glVertexAttrib1d)
+GL_TRACE_FUNCTION(glVertexAttrib1dv)
+GL_TRACE_FUNCTION(glVertexAttrib1f)
+GL_TRACE_FUNCTION(glVertexAttrib1fv)
+GL_TRACE_FUNCTION(glVertexAttrib1s)
+GL_TRACE_FUNCTION(glVertexAttrib1sv)
+GL_TRACE_FUNCTION(glVertexAttrib2d)
+GL_TRACE_FUNCTION(glVertexAttrib2dv)
+GL_TRACE_FUNCTION(glVertexAttrib2f)
+GL_TRACE_FUNCTION(glVertexAttrib2fv)
+GL_TRACE_FUNCTION(glVertexAttrib2s)
+GL_TRACE_FUNCTION(glVertexAttrib2sv)
+GL_TRACE_FUNCTION(glVertexAttrib3d)
+GL_TRACE_FUNCTION(glVertexAttrib3dv)
+GL_TRACE_FUNCTION(glVertexAttrib3f)
+GL_TRACE_FUNCTION(glVertexAttrib3fv)
+GL_TRACE_FUNCTION(glVertexAttrib3s)
+GL_TRACE_FUNCTION(glVertexAttrib3sv)
+GL_TRACE_FUNCTION(glVertexAttrib4Nbv)
+GL_TRACE_FUNCTION(glVertexAttrib4Niv)
+GL_TRACE_FUNCTION(glVertexAttrib4Nsv)
+GL_TRACE_FUNCTION(glVertexAttrib4Nub)
+GL_TRACE_FUNCTION(glVertexAttrib4Nubv)
+GL_TRACE_FUNCTION(glVertexAttrib4Nuiv)
+GL_TRACE_FUNCTION(glVertexAttrib4Nusv)
+GL_TRACE_FUNCTION(glVertexAttrib4bv)
+GL_TRACE_FUNCTION(glVertexAttrib4d)
+GL_TRACE_FUNCTION(glVertexAttrib4dv)
+GL_TRACE_FUNCTION(glVertexAttrib4f)
+GL_TRACE_FUNCTION(glVertexAttrib4fv)
+GL_TRACE_FUNCTION(glVertexAttrib4iv)
+GL_TRACE_FUNCTION(glVertexAttrib4s)
+GL_TRACE_FUNCTION(glVertexAttrib4sv)
+GL_TRACE_FUNCTION(glVertexAttrib4ubv)
+GL_TRACE_FUNCTION(glVertexAttrib4uiv)
+GL_TRACE_FUNCTION(glVertexAttrib4usv)
+GL_TRACE_FUNCTION(glVertexAttribPointer)
+GL_TRACE_FUNCTION(glUniformMatrix2x3fv)
+GL_TRACE_FUNCTION(glUniformMatrix3x2fv)
+GL_TRACE_FUNCTION(glUniformMatrix2x4fv)
+GL_TRACE_FUNCTION(glUniformMatrix4x2fv)
+GL_TRACE_FUNCTION(glUniformMatrix3x4fv)
+GL_TRACE_FUNCTION(glUniformMatrix4x3fv)
+GL_TRACE_FUNCTION(glColorMaski)
+GL_TRACE_FUNCTION(glGetBooleani_v)
+GL_TRACE_FUNCTION(glGetIntegeri_v)
+GL_TRACE_FUNCTION(glEnablei)
+GL_TRACE_FUNCTION(glDisablei)
+GL_TRACE_FUNCTION(glIsEnabledi)
+GL_TRACE_FUNCTION(glBeginTransformFeedback)
+GL_TRACE_FUNCTION(glEndTransformFeedback)
+GL_TRACE_FUNCTION(glBindBufferRange)
+GL_TRACE_FUNCTION(glBindBufferBase)
+GL_TRACE_FUNCTION(glTransformFeedbackVaryings)
+GL_TRACE_FUNCTION(glGetTransformFeedbackVarying)
+GL_TRACE_FUNCTION(glClampColor)
+GL_TRACE_FUNCTION(glBeginConditionalRender)
+GL_TRACE_FUNCTION(glEndConditionalRender)
+GL_TRACE_FUNCTION(glVertexAttribIPointer)
+GL_TRACE_FUNCTION(glGetVertexAttribIiv)
+GL_TRACE_FUNCTION(glGetVertexAttribIuiv)
+GL_TRACE_FUNCTION(glVertexAttribI1i)
+GL_TRACE_FUNCTION(glVertexAttribI2i)
+GL_TRACE_FUNCTION(glVertexAttribI3i)
+GL_TRACE_FUNCTION(glVertexAttribI4i)
+GL_TRACE_FUNCTION(glVertexAttribI1ui)
+GL_TRACE_FUNCTION(glVertexAttribI2ui)
+GL_TRACE_FUNCTION(glVertexAttribI3ui)
+GL_TRACE_FUNCTION(glVertexAttribI4ui)
+GL_TRACE_FUNCTION(glVertexAttribI1iv)
+GL_TRACE_FUNCTION(glVertexAttribI2iv)
+GL_TRACE_FUNCTION(glVertexAttribI3iv)
+GL_TRACE_FUNCTION(glVertexAttribI4iv)
+GL_TRACE_FUNCTION(glVertexAttribI1uiv)
+GL_TRACE_FUNCTION(glVertexAttribI2uiv)
+GL_TRACE_FUNCTION(glVertexAttribI3uiv)
+GL_TRACE_FUNCTION(glVertexAttribI4uiv)
+GL_TRACE_FUNCTION(glVertexAttribI4bv)
+GL_TRACE_FUNCTION(glVertexAttribI4sv)
+GL_TRACE_FUNCTION(glVertexAttribI4ubv)
+GL_TRACE_FUNCTION(glVertexAttribI4usv)
+GL_TRACE_FUNCTION(glGetUniformuiv)
+GL_TRACE_FUNCTION(glBindFragDataLocation)
+GL_TRACE_FUNCTION(glGetFragDataLocation)
+GL_TRACE_FUNCTION(glUniform1ui)
+GL_TRACE_FUNCTION(glUniform2ui)
+GL_TRACE_FUNCTION(glUniform3ui)
+GL_TRACE_FUNCTION(glUniform4ui)
+GL_TRACE_FUNCTION(glUniform1uiv)
+GL_TRACE_FUNCTION(glUniform2uiv)
+GL_TRACE_FUNCTION(glUniform3uiv)
+GL_TRACE_FUNCTION(glUniform4uiv)
+GL_TRACE_FUNCTION(glTexParameterIiv)
+GL_TRACE_FUNCTION(glTexParameterIuiv)
+GL_TRACE_FUNCTION(glGetTexParameterIiv)
+GL_TRACE_FUNCTION(glGetTexParameterIuiv)
+GL_TRACE_FUNCTION(glClearBufferiv)
+GL_TRACE_FUNCTION(glClearBufferuiv)
+GL_TRACE_FUNCTION(glClearBufferfv)
+GL_TRACE_FUNCTION(glClearBufferfi)
+GL_TRACE_FUNCTION(glGetStringi)
+GL_TRACE_FUNCTION(glIsRenderbuffer)
+GL_TRACE_FUNCTION(glBindRenderbuffer)
+GL_TRACE_FUNCTION(glDeleteRenderbuffers)
+GL_TRACE_FUNCTION(glGenRenderbuffers)
+GL_TRACE_FUNCTION(glRenderbufferStorage)
+GL_TRACE_FUNCTION(glGetRenderbufferParameteriv)
+GL_TRACE_FUNCTION(glIsFramebuffer)
+GL_TRACE_FUNCTION(glBindFramebuffer)
+GL_TRACE_FUNCTION(glDeleteFramebuffers)
+GL_TRACE_FUNCTION(glGenFramebuffers)
+GL_TRACE_FUNCTION(glCheckFramebufferStatus)
+GL_TRACE_FUNCTION(glFramebufferTexture1D)
+GL_TRACE_FUNCTION(glFramebufferTexture2D)
+GL_TRACE_FUNCTION(glFramebufferTexture3D)
+GL_TRACE_FUNCTION(glFramebufferRenderbuffer)
+GL_TRACE_FUNCTION(glGetFramebufferAttachmentParameteriv)
+GL_TRACE_FUNCTION(glGenerateMipmap)
+GL_TRACE_FUNCTION(glBlitFramebuffer)
+GL_TRACE_FUNCTION(glRenderbufferStorageMultisample)
+GL_TRACE_FUNCTION(glFramebufferTextureLayer)
+GL_TRACE_FUNCTION(glMapBufferRange)
+GL_TRACE_FUNCTION(glFlushMappedBufferRange)
+GL_TRACE_FUNCTION(glBindVertexArray)
+GL_TRACE_FUNCTION(glDeleteVertexArrays)
+GL_TRACE_FUNCTION(glGenVertexArrays)
+GL_TRACE_FUNCTION(glIsVertexArray)
+GL_TRACE_FUNCTION(glDrawArraysInstanced)
+GL_TRACE_FUNCTION(glDrawElementsInstanced)
+GL_TRACE_FUNCTION(glTexBuffer)
+GL_TRACE_FUNCTION(glPrimitiveRestartIndex)
+GL_TRACE_FUNCTION(glCopyBufferSubData)
+GL_TRACE_FUNCTION(glGetUniformIndices)
+GL_TRACE_FUNCTION(glGetActiveUniformsiv)
+GL_TRACE_FUNCTION(glGetActiveUniformName)
+GL_TRACE_FUNCTION(glGetUniformBlockIndex)
+GL_TRACE_FUNCTION(glGetActiveUniformBlockiv)
+GL_TRACE_FUNCTION(glGetActiveUniformBlockName)
+GL_TRACE_FUNCTION(glUniformBlockBinding)
+GL_TRACE_FUNCTION(glDrawElementsBaseVertex)
+GL_TRACE_FUNCTION(glDrawRangeElementsBaseVertex)
+GL_TRACE_FUNCTION(glDrawElementsInstancedBaseVertex)
+GL_TRACE_FUNCTION(glMultiDrawElementsBaseVertex)
+GL_TRACE_FUNCTION(glProvokingVertex)
+GL_TRACE_FUNCTION(glFenceSync)
+GL_TRACE_FUNCTION(glIsSync)
+GL_TRACE_FUNCTION(glDeleteSync)
+GL_TRACE_FUNCTION(glClientWaitSync)
+GL_TRACE_FUNCTION(glWaitSync)
+GL_TRACE_FUNCTION(glGetInteger64v)
+GL_TRACE_FUNCTION(glGetSynciv)
+GL_TRACE_FUNCTION(glGetInteger64i_v)
+GL_TRACE_FUNCTION(glGetBufferParameteri64v)
+GL_TRACE_FUNCTION(glFramebufferTexture)
+GL_TRACE_FUNCTION(glTexImage2DMultisample)
+GL_TRACE_FUNCTION(glTexImage3DMultisample)
+GL_TRACE_FUNCTION(glGetMultisamplefv)
+GL_TRACE_FUNCTION(glSampleMaski)
+GL_TRACE_FUNCTION(glBindFragDataLocationIndexed)
+GL_TRACE_FUNCTION(glGetFragDataIndex)
+GL_TRACE_FUNCTION(glGenSamplers)
+GL_TRACE_FUNCTION(glDeleteSamplers)
+GL_TRACE_FUNCTION(glIsSampler)
+GL_TRACE_FUNCTION(glBindSampler)
+GL_TRACE_FUNCTION(glSamplerParameteri)
+GL_TRACE_FUNCTION(glSamplerParameteriv)
+GL_TRACE_FUNCTION(glSamplerParameterf)
+GL_TRACE_FUNCTION(glSamplerParameterfv)
+GL_TRACE_FUNCTION(glSamplerParameterIiv)
+GL_TRACE_FUNCTION(glSamplerParameterIuiv)
+GL_TRACE_FUNCTION(glGetSamplerParameteriv)
+GL_TRACE_FUNCTION(glGetSamplerParameterIiv)
+GL_TRACE_FUNCTION(glGetSamplerParameterfv)
+GL_TRACE_FUNCTION(glGetSamplerParameterIuiv)
+GL_TRACE_FUNCTION(glQueryCounter)
+GL_TRACE_FUNCTION(glGetQueryObjecti64v)
+GL_TRACE_FUNCTION(glGetQueryObjectui64v)
+GL_TRACE_FUNCTION(glVertexAttribDivisor)
+GL_TRACE_FUNCTION(glVertexAttribP1ui)
+GL_TRACE_FUNCTION(glVertexAttribP1uiv)
+GL_TRACE_FUNCTION(glVertexAttribP2ui)
+GL_TRACE_FUNCTION(glVertexAttribP2uiv)
+GL_TRACE_FUNCTION(glVertexAttribP3ui)
+GL_TRACE_FUNCTION(glVertexAttribP3uiv)
+GL_TRACE_FUNCTION(glVertexAttribP4ui)
+GL_TRACE_FUNCTION(glVertexAttribP4uiv)
+GL_TRACE_FUNCTION(glVertexP2ui)
+GL_TRACE_FUNCTION(glVertexP2uiv)
+GL_TRACE_FUNCTION(glVertexP3ui)
+GL_TRACE_FUNCTION(glVertexP3uiv)
+GL_TRACE_FUNCTION(glVertexP4ui)
+GL_TRACE_FUNCTION(glVertexP4uiv)
+GL_TRACE_FUNCTION(glTexCoordP1ui)
+GL_TRACE_FUNCTION(glTexCoordP1uiv)
+GL_TRACE_FUNCTION(glTexCoordP2ui)
+GL_TRACE_FUNCTION(glTexCoordP2uiv)
+GL_TRACE_FUNCTION(glTexCoordP3ui)
+GL_TRACE_FUNCTION(glTexCoordP3uiv)
+GL_TRACE_FUNCTION(glTexCoordP4ui)
+GL_TRACE_FUNCTION(glTexCoordP4uiv)
+GL_TRACE_FUNCTION(glMultiTexCoordP1ui)
+GL_TRACE_FUNCTION(glMultiTexCoordP1uiv)
+GL_TRACE_FUNCTION(glMultiTexCoordP2ui)
+GL_TRACE_FUNCTION(glMultiTexCoordP2uiv)
+GL_TRACE_FUNCTION(glMultiTexCoordP3ui)
+GL_TRACE_FUNCTION(glMultiTexCoordP3uiv)
+GL_TRACE_FUNCTION(glMultiTexCoordP4ui)
+GL_TRACE_FUNCTION(glMultiTexCoordP4uiv)
+GL_TRACE_FUNCTION(glNormalP3ui)
+GL_TRACE_FUNCTION(glNormalP3uiv)
+GL_TRACE_FUNCTION(glColorP3ui)
+GL_TRACE_FUNCTION(glColorP3uiv)
+GL_TRACE_FUNCTION(glColorP4ui)
+GL_TRACE_FUNCTION(glColorP4uiv)
+GL_TRACE_FUNCTION(glSecondaryColorP3ui)
+GL_TRACE_FUNCTION(glSecondaryColorP3uiv)
+GL_TRACE_FUNCTION(glMinSampleShading)
+GL_TRACE_FUNCTION(glBlendEquationi)
+GL_TRACE_FUNCTION(glBlendEquationSeparatei)
+GL_TRACE_FUNCTION(glBlendFunci)
+GL_TRACE_FUNCTION(glBlendFuncSeparatei)
+GL_TRACE_FUNCTION(glDrawArraysIndirect)
+GL_TRACE_FUNCTION(glDrawElementsIndirect)
+GL_TRACE_FUNCTION(glUniform1d)
+GL_TRACE_FUNCTION(glUniform2d)
+GL_TRACE_FUNCTION(glUniform3d)
+GL_TRACE_FUNCTION(glUniform4d)
+GL_TRACE_FUNCTION(glUniform1dv)
+GL_TRACE_FUNCTION(glUniform2dv)
+GL_TRACE_FUNCTION(glUniform3dv)
+GL_TRACE_FUNCTION(glUniform4dv)
+GL_TRACE_FUNCTION(glUniformMatrix2dv)
+GL_TRACE_FUNCTION(glUniformMatrix3dv)
+GL_TRACE_FUNCTION(glUniformMatrix4dv)
+GL_TRACE_FUNCTION(glUniformMatrix2x3dv)
+GL_TRACE_FUNCTION(glUniformMatrix2x4dv)
+GL_TRACE_FUNCTION(glUniformMatrix3x2dv)
+GL_TRACE_FUNCTION(glUniformMatrix3x4dv)
+GL_TRACE_FUNCTION(glUniformMatrix4x2dv)
+GL_TRACE_FUNCTION(glUniformMatrix4x3dv)
+GL_TRACE_FUNCTION(glGetUniformdv)
+GL_TRACE_FUNCTION(glGetSubroutineUniformLocation)
+GL_TRACE_FUNCTION(glGetSubroutineIndex)
+GL_TRACE_FUNCTION(glGetActiveSubroutineUniformiv)
+GL_TRACE_FUNCTION(glGetActiveSubroutineUniformName)
+GL_TRACE_FUNCTION(glGetActiveSubroutineName)
+GL_TRACE_FUNCTION(glUniformSubroutinesuiv)
+GL_TRACE_FUNCTION(glGetUniformSubroutineuiv)
+GL_TRACE_FUNCTION(glGetProgramStageiv)
+GL_TRACE_FUNCTION(glPatchParameteri)
+GL_TRACE_FUNCTION(glPatchParameterfv)
+GL_TRACE_FUNCTION(glBindTransformFeedback)
+GL_TRACE_FUNCTION(glDeleteTransformFeedbacks)
+GL_TRACE_FUNCTION(glGenTransformFeedbacks)
+GL_TRACE_FUNCTION(glIsTransformFeedback)
+GL_TRACE_FUNCTION(glPauseTransformFeedback)
+GL_TRACE_FUNCTION(glResumeTransformFeedback)
+GL_TRACE_FUNCTION(glDrawTransformFeedback)
+GL_TRACE_FUNCTION(glDrawTransformFeedbackStream)
+GL_TRACE_FUNCTION(glBeginQueryIndexed)
+GL_TRACE_FUNCTION(glEndQueryIndexed)
+GL_TRACE_FUNCTION(glGetQueryIndexediv)
+GL_TRACE_FUNCTION(glReleaseShaderCompiler)
+GL_TRACE_FUNCTION(glShaderBinary)
+GL_TRACE_FUNCTION(glGetShaderPrecisionFormat)
+GL_TRACE_FUNCTION(glDepthRangef)
+GL_TRACE_FUNCTION(glClearDepthf)
+GL_TRACE_FUNCTION(glGetProgramBinary)
+GL_TRACE_FUNCTION(glProgramBinary)
+GL_TRACE_FUNCTION(glProgramParameteri)
+GL_TRACE_FUNCTION(glUseProgramStages)
+GL_TRACE_FUNCTION(glActiveShaderProgram)
+GL_TRACE_FUNCTION(glCreateShaderProgramv)
+GL_TRACE_FUNCTION(glBindProgramPipeline)
+GL_TRACE_FUNCTION(glDeleteProgramPipelines)
+GL_TRACE_FUNCTION(glGenProgramPipelines)
+GL_TRACE_FUNCTION(glIsProgramPipeline)
+GL_TRACE_FUNCTION(glGetProgramPipelineiv)
+GL_TRACE_FUNCTION(glProgramUniform1i)
+GL_TRACE_FUNCTION(glProgramUniform1iv)
+GL_TRACE_FUNCTION(glProgramUniform1f)
+GL_TRACE_FUNCTION(glProgramUniform1fv)
+GL_TRACE_FUNCTION(glProgramUniform1d)
+GL_TRACE_FUNCTION(glProgramUniform1dv)
+GL_TRACE_FUNCTION(glProgramUniform1ui)
+GL_TRACE_FUNCTION(glProgramUniform1uiv)
+GL_TRACE_FUNCTION(glProgramUniform2i)
+GL_TRACE_FUNCTION(glProgramUniform2iv)
+GL_TRACE_FUNCTION(glProgramUniform2f)
+GL_TRACE_FUNCTION(glProgramUniform2fv)
+GL_TRACE_FUNCTION(glProgramUniform2d)
+GL_TRACE_FUNCTION(glProgramUniform2dv)
+GL_TRACE_FUNCTION(glProgramUniform2ui)
+GL_TRACE_FUNCTION(glProgramUniform2uiv)
+GL_TRACE_FUNCTION(glProgramUniform3i)
+GL_TRACE_FUNCTION(glProgramUniform3iv)
+GL_TRACE_FUNCTION(glProgramUniform3f)
+GL_TRACE_FUNCTION(glProgramUniform3fv)
+GL_TRACE_FUNCTION(glProgramUniform3d)
+GL_TRACE_FUNCTION(glProgramUniform3dv)
+GL_TRACE_FUNCTION(glProgramUniform3ui)
+GL_TRACE_FUNCTION(glProgramUniform3uiv)
+GL_TRACE_FUNCTION(glProgramUniform4i)
+GL_TRACE_FUNCTION(glProgramUniform4iv)
+GL_TRACE_FUNCTION(glProgramUniform4f)
+GL_TRACE_FUNCTION(glProgramUniform4fv)
+GL_TRACE_FUNCTION(glProgramUniform4d)
+GL_TRACE_FUNCTION(glProgramUniform4dv)
+GL_TRACE_FUNCTION(glProgramUniform4ui)
+GL_TRACE_FUNCTION(glProgramUniform4uiv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2x3fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3x2fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2x4fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4x2fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3x4fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4x3fv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2x3dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3x2dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix2x4dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4x2dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix3x4dv)
+GL_TRACE_FUNCTION(glProgramUniformMatrix4x3dv)
+GL_TRACE_FUNCTION(glValidateProgramPipeline)
+GL_TRACE_FUNCTION(glGetProgramPipelineInfoLog)
+GL_TRACE_FUNCTION(glVertexAttribL1d)
+GL_TRACE_FUNCTION(glVertexAttribL2d)
+GL_TRACE_FUNCTION(glVertexAttribL3d)
+GL_TRACE_FUNCTION(glVertexAttribL4d)
+GL_TRACE_FUNCTION(glVertexAttribL1dv)
+GL_TRACE_FUNCTION(glVertexAttribL2dv)
+GL_TRACE_FUNCTION(glVertexAttribL3dv)
+GL_TRACE_FUNCTION(glVertexAttribL4dv)
+GL_TRACE_FUNCTION(glVertexAttribLPointer)
+GL_TRACE_FUNCTION(glGetVertexAttribLdv)
+GL_TRACE_FUNCTION(glViewportArrayv)
+GL_TRACE_FUNCTION(glViewportIndexedf)
+GL_TRACE_FUNCTION(glViewportIndexedfv)
+GL_TRACE_FUNCTION(glScissorArrayv)
+GL_TRACE_FUNCTION(glScissorIndexed)
+GL_TRACE_FUNCTION(glScissorIndexedv)
+GL_TRACE_FUNCTION(glDepthRangeArrayv)
+GL_TRACE_FUNCTION(glDepthRangeIndexed)
+GL_TRACE_FUNCTION(glGetFloati_v)
+GL_TRACE_FUNCTION(glGetDoublei_v)
+GL_TRACE_FUNCTION(glDrawArraysInstancedBaseInstance)
+GL_TRACE_FUNCTION(glDrawElementsInstancedBaseInstance)
+GL_TRACE_FUNCTION(glDrawElementsInstancedBaseVertexBaseInstance)
+GL_TRACE_FUNCTION(glGetInternalformativ)
+GL_TRACE_FUNCTION(glGetActiveAtomicCounterBufferiv)
+GL_TRACE_FUNCTION(glBindImageTexture)
+GL_TRACE_FUNCTION(glMemoryBarrier)
+GL_TRACE_FUNCTION(glTexStorage1D)
+GL_TRACE_FUNCTION(glTexStorage2D)
+GL_TRACE_FUNCTION(glTexStorage3D)
+GL_TRACE_FUNCTION(glDrawTransformFeedbackInstanced)
+GL_TRACE_FUNCTION(glDrawTransformFeedbackStreamInstanced)
+GL_TRACE_FUNCTION(glClearBufferData)
+GL_TRACE_FUNCTION(glClearBufferSubData)
+GL_TRACE_FUNCTION(glDispatchCompute)
+GL_TRACE_FUNCTION(glDispatchComputeIndirect)
+GL_TRACE_FUNCTION(glCopyImageSubData)
+GL_TRACE_FUNCTION(glFramebufferParameteri)
+GL_TRACE_FUNCTION(glGetFramebufferParameteriv)
+GL_TRACE_FUNCTION(glGetInternalformati64v)
+GL_TRACE_FUNCTION(glInvalidateTexSubImage)
+GL_TRACE_FUNCTION(glInvalidateTexImage)
+GL_TRACE_FUNCTION(glInvalidateBufferSubData)
+GL_TRACE_FUNCTION(glInvalidateBufferData)
+GL_TRACE_FUNCTION(glInvalidateFramebuffer)
+GL_TRACE_FUNCTION(glInvalidateSubFramebuffer)
+GL_TRACE_FUNCTION(glMultiDrawArraysIndirect)
+GL_TRACE_FUNCTION(glMultiDrawElementsIndirect)
+GL_TRACE_FUNCTION(glGetProgramInterfaceiv)
+GL_TRACE_FUNCTION(glGetProgramResourceIndex)
+GL_TRACE_FUNCTION(glGetProgramResourceName)
+GL_TRACE_FUNCTION(glGetProgramResourceiv)
+GL_TRACE_FUNCTION(glGetProgramResourceLocation)
+GL_TRACE_FUNCTION(glGetProgramResourceLocationIndex)
+GL_TRACE_FUNCTION(glShaderStorageBlockBinding)
+GL_TRACE_FUNCTION(glTexBufferRange)
+GL_TRACE_FUNCTION(glTexStorage2DMultisample)
+GL_TRACE_FUNCTION(glTexStorage3DMultisample)
+GL_TRACE_FUNCTION(glTextureView)
+GL_TRACE_FUNCTION(glBindVertexBuffer)
+GL_TRACE_FUNCTION(glVertexAttribFormat)
+GL_TRACE_FUNCTION(glVertexAttribIFormat)
+GL_TRACE_FUNCTION(glVertexAttribLFormat)
+GL_TRACE_FUNCTION(glVertexAttribBinding)
+GL_TRACE_FUNCTION(glVertexBindingDivisor)
+GL_TRACE_FUNCTION(glDebugMessageControl)
+GL_TRACE_FUNCTION(glDebugMessageInsert)
+GL_TRACE_FUNCTION(glDebugMessageCallback)
+GL_TRACE_FUNCTION(glGetDebugMessageLog)
+GL_TRACE_FUNCTION(glPushDebugGroup)
+GL_TRACE_FUNCTION(glPopDebugGroup)
+GL_TRACE_FUNCTION(glObjectLabel)
+GL_TRACE_FUNCTION(glGetObjectLabel)
+GL_TRACE_FUNCTION(glObjectPtrLabel)
+GL_TRACE_FUNCTION(glGetObjectPtrLabel)
+GL_TRACE_FUNCTION(glBufferStorage)
+GL_TRACE_FUNCTION(glClearTexImage)
+GL_TRACE_FUNCTION(glClearTexSubImage)
+GL_TRACE_FUNCTION(glBindBuffersBase)
+GL_TRACE_FUNCTION(glBindBuffersRange)
+GL_TRACE_FUNCTION(glBindTextures)
+GL_TRACE_FUNCTION(glBindSamplers)
+GL_TRACE_FUNCTION(glBindImageTextures)
+GL_TRACE_FUNCTION(glBindVertexBuffers)
+GL_TRACE_FUNCTION(glClipControl)
+GL_TRACE_FUNCTION(glCreateTransformFeedbacks)
+GL_TRACE_FUNCTION(glTransformFeedbackBufferBase)
+GL_TRACE_FUNCTION(glTransformFeedbackBufferRange)
+GL_TRACE_FUNCTION(glGetTransformFeedbackiv)
+GL_TRACE_FUNCTION(glGetTransformFeedbacki_v)
+GL_TRACE_FUNCTION(glGetTransformFeedbacki64_v)
+GL_TRACE_FUNCTION(glCreateBuffers)
+GL_TRACE_FUNCTION(glNamedBufferStorage)
+GL_TRACE_FUNCTION(glNamedBufferData)
+GL_TRACE_FUNCTION(glNamedBufferSubData)
+GL_TRACE_FUNCTION(glCopyNamedBufferSubData)
+GL_TRACE_FUNCTION(glClearNamedBufferData)
+GL_TRACE_FUNCTION(glClearNamedBufferSubData)
+GL_TRACE_FUNCTION(glMapNamedBuffer)
+GL_TRACE_FUNCTION(glMapNamedBufferRange)
+GL_TRACE_FUNCTION(glUnmapNamedBuffer)
+GL_TRACE_FUNCTION(glFlushMappedNamedBufferRange)
+GL_TRACE_FUNCTION(glGetNamedBufferParameteriv)
+GL_TRACE_FUNCTION(glGetNamedBufferParameteri64v)
+GL_TRACE_FUNCTION(glGetNamedBufferPointerv)
+GL_TRACE_FUNCTION(glGetNamedBufferSubData)
+GL_TRACE_FUNCTION(glCreateFramebuffers)
+GL_TRACE_FUNCTION(glNamedFramebufferRenderbuffer)
+GL_TRACE_FUNCTION(glNamedFramebufferParameteri)
+GL_TRACE_FUNCTION(glNamedFramebufferTexture)
+GL_TRACE_FUNCTION(glNamedFramebufferTextureLayer)
+GL_TRACE_FUNCTION(glNamedFramebufferDrawBuffer)
+GL_TRACE_FUNCTION(glNamedFramebufferDrawBuffers)
+GL_TRACE_FUNCTION(glNamedFramebufferReadBuffer)
+GL_TRACE_FUNCTION(glInvalidateNamedFramebufferData)
+GL_TRACE_FUNCTION(glInvalidateNamedFramebufferSubData)
+GL_TRACE_FUNCTION(glClearNamedFramebufferiv)
+GL_TRACE_FUNCTION(glClearNamedFramebufferuiv)
+GL_TRACE_FUNCTION(glClearNamedFramebufferfv)
+GL_TRACE_FUNCTION(glClearNamedFramebufferfi)
+GL_TRACE_FUNCTION(glBlitNamedFramebuffer)
+GL_TRACE_FUNCTION(glCheckNamedFramebufferStatus)
+GL_TRACE_FUNCTION(glGetNamedFramebufferParameteriv)
+GL_TRACE_FUNCTION(glGetNamedFramebufferAttachmentParameteriv)
+GL_TRACE_FUNCTION(glCreateRenderbuffers)
+GL_TRACE_FUNCTION(glNamedRenderbufferStorage)
+GL_TRACE_FUNCTION(glNamedRenderbufferStorageMultisample)
+GL_TRACE_FUNCTION(glGetNamedRenderbufferParameteriv)
+GL_TRACE_FUNCTION(glCreateTextures)
+GL_TRACE_FUNCTION(glTextureBuffer)
+GL_TRACE_FUNCTION(glTextureBufferRange)
+GL_TRACE_FUNCTION(glTextureStorage1D)
+GL_TRACE_FUNCTION(glTextureStorage2D)
+GL_TRACE_FUNCTION(glTextureStorage3D)
+GL_TRACE_FUNCTION(glTextureStorage2DMultisample)
+GL_TRACE_FUNCTION(glTextureStorage3DMultisample)
+GL_TRACE_FUNCTION(glTextureSubImage1D)
+GL_TRACE_FUNCTION(glTextureSubImage2D)
+GL_TRACE_FUNCTION(glTextureSubImage3D)
+GL_TRACE_FUNCTION(glCompressedTextureSubImage1D)
+GL_TRACE_FUNCTION(glCompressedTextureSubImage2D)
+GL_TRACE_FUNCTION(glCompressedTextureSubImage3D)
+GL_TRACE_FUNCTION(glCopyTextureSubImage1D)
+GL_TRACE_FUNCTION(glCopyTextureSubImage2D)
+GL_TRACE_FUNCTION(glCopyTextureSubImage3D)
+GL_TRACE_FUNCTION(glTextureParameterf)
+GL_TRACE_FUNCTION(glTextureParameterfv)
+GL_TRACE_FUNCTION(glTextureParameteri)
+GL_TRACE_FUNCTION(glTextureParameterIiv)
+GL_TRACE_FUNCTION(glTextureParameterIuiv)
+GL_TRACE_FUNCTION(glTextureParameteriv)
+GL_TRACE_FUNCTION(glGenerateTextureMipmap)
+GL_TRACE_FUNCTION(glBindTextureUnit)
+GL_TRACE_FUNCTION(glGetTextureImage)
+GL_TRACE_FUNCTION(glGetCompressedTextureImage)
+GL_TRACE_FUNCTION(glGetTextureLevelParameterfv)
+GL_TRACE_FUNCTION(glGetTextureLevelParameteriv)
+GL_TRACE_FUNCTION(glGetTextureParameterfv)
+GL_TRACE_FUNCTION(glGetTextureParameterIiv)
+GL_TRACE_FUNCTION(glGetTextureParameterIuiv)
+GL_TRACE_FUNCTION(glGetTextureParameteriv)
+GL_TRACE_FUNCTION(glCreateVertexArrays)
+GL_TRACE_FUNCTION(glDisableVertexArrayAttrib)
+GL_TRACE_FUNCTION(glEnableVertexArrayAttrib)
+GL_TRACE_FUNCTION(glVertexArrayElementBuffer)
+GL_TRACE_FUNCTION(glVertexArrayVertexBuffer)
+GL_TRACE_FUNCTION(glVertexArrayVertexBuffers)
+GL_TRACE_FUNCTION(glVertexArrayAttribBinding)
+GL_TRACE_FUNCTION(glVertexArrayAttribFormat)
+GL_TRACE_FUNCTION(glVertexArrayAttribIFormat)
+GL_TRACE_FUNCTION(glVertexArrayAttribLFormat)
+GL_TRACE_FUNCTION(glVertexArrayBindingDivisor)
+GL_TRACE_FUNCTION(glGetVertexArrayiv)
+GL_TRACE_FUNCTION(glGetVertexArrayIndexediv)
+GL_TRACE_FUNCTION(glGetVertexArrayIndexed64iv)
+GL_TRACE_FUNCTION(glCreateSamplers)
+GL_TRACE_FUNCTION(glCreateProgramPipelines)
+GL_TRACE_FUNCTION(glCreateQueries)
+GL_TRACE_FUNCTION(glGetQueryBufferObjecti64v)
+GL_TRACE_FUNCTION(glGetQueryBufferObjectiv)
+GL_TRACE_FUNCTION(glGetQueryBufferObjectui64v)
+GL_TRACE_FUNCTION(glGetQueryBufferObjectuiv)
+GL_TRACE_FUNCTION(glMemoryBarrierByRegion)
+GL_TRACE_FUNCTION(glGetTextureSubImage)
+GL_TRACE_FUNCTION(glGetCompressedTextureSubImage)
+GL_TRACE_FUNCTION(glGetGraphicsResetStatus)
+GL_TRACE_FUNCTION(glGetnCompressedTexImage)
+GL_TRACE_FUNCTION(glGetnTexImage)
+GL_TRACE_FUNCTION(glGetnUniformdv)
+GL_TRACE_FUNCTION(glGetnUniformfv)
+GL_TRACE_FUNCTION(glGetnUniformiv)
+GL_TRACE_FUNCTION(glGetnUniformuiv)
+GL_TRACE_FUNCTION(glReadnPixels)
+GL_TRACE_FUNCTION(glGetnMapdv)
+GL_TRACE_FUNCTION(glGetnMapfv)
+GL_TRACE_FUNCTION(glGetnMapiv)
+GL_TRACE_FUNCTION(glGetnPixelMapfv)
+GL_TRACE_FUNCTION(glGetnPixelMapuiv)
+GL_TRACE_FUNCTION(glGetnPixelMapusv)
+GL_TRACE_FUNCTION(glGetnPolygonStipple)
+GL_TRACE_FUNCTION(glGetnColorTable)
+GL_TRACE_FUNCTION(glGetnConvolutionFilter)
+GL_TRACE_FUNCTION(glGetnSeparableFilter)
+GL_TRACE_FUNCTION(glGetnHistogram)
+GL_TRACE_FUNCTION(glGetnMinmax)
+GL_TRACE_FUNCTION(glTextureBarrier)
+GL_TRACE_FUNCTION(glSpecializeShader)
+GL_TRACE_FUNCTION(glMultiDrawArraysIndirectCount)
+GL_TRACE_FUNCTION(glMultiDrawElementsIndirectCount)
+GL_TRACE_FUNCTION(glPolygonOffsetClamp)
@@ -0,0 +1,173 @@
+#include <cstring>
+
+#include "gpu_profiler.hpp"
+
+// to check the context for an extension by name
+static bool has_extension(const char *name)
+{
+    GLint count{};
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (GLint i = 0; i < count; i++)
+    {
+        if (std::strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// to check whether a query's result can be read without waiting
+static bool available(const query &a_query)
+{
+    GLint ready{};
+    glGetQueryObjectiv(a_query.get(), GL_QUERY_RESULT_AVAILABLE, &ready);
+
+    return ready != 0;
+}
+
+gpu_profiler::gpu_profiler()
+{
+    // core in 4.6, the extension has the same enums and entry points
+    pipeline_statistics = GLAD_GL_VERSION_4_6 || has_extension("GL_ARB_pipeline_statistics_query");
+}
+
+void gpu_profiler::create_queries()
+{
+    for (frame_slot &slot : slots)
+    {
+        for (int i = 0; i < GPU_PROFILER_SCOPES * 2; i++)
+            slot.timestamps.push_back(query::create());
+
+        for (int i = 0; pipeline_statistics && i < GPU_PROFILER_STAT_SCOPES * 2; i++)
+            slot.statistics.push_back(query::create());
+
+        slot.scopes.reserve(GPU_PROFILER_SCOPES);
+    }
+}
+
+void gpu_profiler::begin_frame()
+{
+    if (slots[0].timestamps.empty())
+        create_queries();
+
+    frame_slot &slot{slots[frame % GPU_PROFILER_LATENCY]};
+    frame++;
+
+    // a slow gpu drops profiling frames instead of stalling the cpu on them
+    if (slot.pending && !resolve(slot))
+        dropped_frames++;
+
+    slot.scopes.clear();
+    slot.stats_used = 0;
+    slot.pending = true;
+
+    // the gpu clock has its own origin, measured every frame so drift doesn't build up
+    GLint64 gpu_now{};
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    slot.clock_offset = gpu_now - (std::int64_t)profiler::get().now();
+
+    frame_active = true;
+    depth = 0;
+}
+
+int gpu_profiler::begin(const char *name)
+{
+    if (!frame_active)
+        return -1;
+
+    frame_slot &slot{slots[(frame - 1) % GPU_PROFILER_LATENCY]};
+    if (slot.scopes.size() >= GPU_PROFILER_SCOPES)
+        return -1;
+
+    int index{(int)slot.scopes.size()};
+    scope_record record{name, depth, -1};
+
+    // statistics queries of one kind can't nest, so only outermost scopes collect them
+    if (pipeline_statistics && depth == 0 && slot.stats_used < GPU_PROFILER_STAT_SCOPES)
+    {
+        record.stats = slot.stats_used++;
+        glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS, slot.statistics[record.stats * 2].get());
+        glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS, slot.statistics[record.stats * 2 + 1].get());
+    }
+
+    slot.scopes.push_back(record);
+    glQueryCounter(slot.timestamps[index * 2].get(), GL_TIMESTAMP);
+
+    depth++;
+
+    return index;
+}
+
+void gpu_profiler::end(int scope)
+{
+    if (scope < 0)
+        return;
+
+    frame_slot &slot{slots[(frame - 1) % GPU_PROFILER_LATENCY]};
+
+    glQueryCounter(slot.timestamps[scope * 2 + 1].get(), GL_TIMESTAMP);
+
+    if (slot.scopes[scope].stats >= 0)
+    {
+        glEndQuery(GL_VERTEX_SHADER_INVOCATIONS);
+        glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS);
+    }
+
+    depth--;
+}
+
+bool gpu_profiler::resolve(frame_slot &slot)
+{
+    slot.pending = false;
+
+    if (slot.scopes.empty())
+        return true;
+
+    // nested scopes end before their parents, so no single query is known to be the last one issued.
+    // every query is checked, reading one that isn't ready would wait for the gpu
+    for (std::size_t i = 0; i < slot.scopes.size(); i++)
+    {
+        const scope_record &record{slot.scopes[i]};
+
+        if (!available(slot.timestamps[i * 2]) || !available(slot.timestamps[i * 2 + 1]))
+            return false;
+
+        if (record.stats >= 0 && (!available(slot.statistics[record.stats * 2]) || !available(slot.statistics[record.stats * 2 + 1])))
+            return false;
+    }
+
+    results.clear();
+
+    for (std::size_t i = 0; i < slot.scopes.size(); i++)
+    {
+        const scope_record &record{slot.scopes[i]};
+
+        GLuint64 begin_time{}, end_time{};
+        glGetQueryObjectui64v(slot.timestamps[i * 2].get(), GL_QUERY_RESULT, &begin_time);
+        glGetQueryObjectui64v(slot.timestamps[i * 2 + 1].get(), GL_QUERY_RESULT, &end_time);
+
+        gpu_timing timing{record.name, record.depth};
+        timing.start = begin_time - slot.clock_offset;
+        timing.ms = (end_time - begin_time) / 1.0e6;
+
+        if (record.stats >= 0)
+        {
+            timing.has_stats = true;
+            glGetQueryObjectui64v(slot.statistics[record.stats * 2].get(), GL_QUERY_RESULT, &timing.vertex_invocations);
+            glGetQueryObjectui64v(slot.statistics[record.stats * 2 + 1].get(), GL_QUERY_RESULT, &timing.fragment_invocations);
+        }
+
+        profiler::get().record_gpu_scope(timing.name, timing.start, end_time - slot.clock_offset);
+
+        if (timing.has_stats)
+        {
+            profiler::get().record_gpu_counter("vertex_invocations", timing.name, timing.start, (double)timing.vertex_invocations);
+            profiler::get().record_gpu_counter("fragment_invocations", timing.name, timing.start, (double)timing.fragment_invocations);
+        }
+
+        results.push_back(timing);
+    }
+
+    return true;
+}
@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gl_handle.hpp"
+#include "profiler.hpp"
+
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+// frames of queries in flight, results are read this many frames late so readback never stalls
+#define GPU_PROFILER_LATENCY 3
+
+// scopes timed per frame, later scopes in a frame are dropped
+#define GPU_PROFILER_SCOPES 256
+
+// outermost scopes per frame that also collect pipeline statistics
+#define GPU_PROFILER_STAT_SCOPES 8
+
+// a resolved gpu scope
+struct gpu_timing
+{
+    const char *name{};
+    int depth{};
+
+    // start in the cpu profiler's clock, in nanoseconds
+    std::uint64_t start{};
+    double ms{};
+
+    // only collected for outermost scopes, and only with pipeline statistics queries
+    bool has_stats{false};
+    std::uint64_t vertex_invocations{};
+    std::uint64_t fragment_invocations{};
+};
+
+// times passes on the gpu with GL_TIMESTAMP queries, which unlike GL_TIME_ELAPSED can nest.
+// results land in the cpu profiler's trace on their own track. use it through the GPU_PROFILE_
+// macros, which compile to nothing unless OXIDIZER_PROFILE is defined. needs a current context
+class gpu_profiler
+{
+public:
+    gpu_profiler();
+
+    gpu_profiler(const gpu_profiler &) = delete;
+    gpu_profiler &operator=(const gpu_profiler &) = delete;
+
+    // to start a frame's scopes, reading back the frame that last used this slot of the ring
+    void begin_frame();
+
+    // to start and end a scope, end takes what begin returned. returns -1 when the frame is full
+    int begin(const char *name);
+    void end(int scope);
+
+    // the most recently resolved frame, GPU_PROFILER_LATENCY frames old
+    const std::vector<gpu_timing> &get_results() const {return results;};
+
+    // frames whose queries weren't ready when their slot came round again
+    std::uint64_t get_dropped_frames() const {return dropped_frames;};
+
+    bool has_pipeline_statistics() const {return pipeline_statistics;};
+
+    // to also time every draw the render queue issues, off by default
+    void set_per_draw(bool enabled) {per_draw = enabled;};
+    bool get_per_draw() const {return per_draw;};
+
+private:
+    struct scope_record
+    {
+        const char *name{};
+        int depth{};
+
+        // index into the slot's statistics queries, -1 without
+        int stats{-1};
+    };
+
+    struct frame_slot
+    {
+        // a begin and an end timestamp per scope
+        std::vector<query> timestamps{};
+
+        // a vertex and a fragment invocation query per statistics scope
+        std::vector<query> statistics{};
+
+        std::vector<scope_record> scopes{};
+        int stats_used{};
+
+        // gpu time minus the profiler's time when the frame began
+        std::int64_t clock_offset{};
+
+        bool pending{false};
+    };
+
+    // to read a slot's queries into results, false if they weren't ready
+    bool resolve(frame_slot &slot);
+
+    // to create every query object on first use, so a build without profiling creates none
+    void create_queries();
+
+    frame_slot slots[GPU_PROFILER_LATENCY]{};
+    std::uint64_t frame{0};
+    bool frame_active{false};
+
+    // depth of the scope being recorded
+    int depth{0};
+
+    bool pipeline_statistics{false};
+    bool per_draw{false};
+
+    std::vector<gpu_timing> results{};
+    std::uint64_t dropped_frames{0};
+};
+
+// times the rest of the enclosing scope on the gpu, does nothing with a null profiler
+class gpu_profile_scope
+{
+public:
+    gpu_profile_scope(gpu_profiler *a_profiler, const char *name)
+        : profiler(a_profiler), scope(a_profiler ? a_profiler->begin(name) : -1) {};
+    ~gpu_profile_scope() {if (profiler) profiler->end(scope);};
+
+    gpu_profile_scope(const gpu_profile_scope &) = delete;
+    gpu_profile_scope &operator=(const gpu_profile_scope &) = delete;
+
+private:
+    gpu_profiler *profiler;
+    int scope;
+};
+
+#ifdef OXIDIZER_PROFILE
+
+#define GPU_PROFILE_SCOPE(profiler, name) gpu_profile_scope PROFILE_CONCAT(gpu_profile_scope_, __LINE__){profiler, name}
+#define GPU_PROFILE_FRAME(profiler) (profiler)->begin_frame()
+
+#else
+
+#define GPU_PROFILE_SCOPE(profiler, name)
+#define GPU_PROFILE_FRAME(profiler) ((void)0)
+
+#endif //OXIDIZER_PROFILE
+
+#endif //GPU_PROFILER_H
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "image_writer.hpp"
+
+static std::uint32_t crc32(const std::uint8_t *data, std::size_t size, std::uint32_t crc = 0)
+{
+    static std::uint32_t table[256]{};
+    static bool table_ready{false};
+
+    if (!table_ready)
+    {
+        for (std::uint32_t n{}; n < 256; n++)
+        {
+            std::uint32_t c{n};
+
+            for (int k{}; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+
+            table[n] = c;
+        }
+
+        table_ready = true;
+    }
+
+    crc = ~crc;
+
+    for (std::size_t i{}; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+static void put_u32(std::vector<std::uint8_t> &out, std::uint32_t value)
+{
+    out.push_back((std::uint8_t)(value >> 24));
+    out.push_back((std::uint8_t)(value >> 16));
+    out.push_back((std::uint8_t)(value >> 8));
+    out.push_back((std::uint8_t)value);
+}
+
+static void put_chunk(std::vector<std::uint8_t> &out, const char *type, const std::vector<std::uint8_t> &data)
+{
+    put_u32(out, (std::uint32_t)data.size());
+
+    std::size_t start{out.size()};
+
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+
+    // the crc covers the type and the data
+    put_u32(out, crc32(out.data() + start, out.size() - start));
+}
+
+bool write_png(const std::string &path, int width, int height, const std::vector<std::uint8_t> &rgb)
+{
+    if (rgb.size() < (std::size_t)width * height * 3)
+    {
+        std::cout << "ERROR::IMAGE::NOT_ENOUGH_DATA: " << path << std::endl;
+        return false;
+    }
+
+    // each row starts with filter type 0, rows are flipped to top-down
+    std::size_t row_size{(std::size_t)width * 3 + 1};
+    std::vector<std::uint8_t> raw(row_size * height);
+
+    for (int y{}; y < height; y++)
+    {
+        std::uint8_t *row{raw.data() + y * row_size};
+        const std::uint8_t *src{rgb.data() + (std::size_t)(height - 1 - y) * width * 3};
+
+        row[0] = 0;
+        std::copy(src, src + width * 3, row + 1);
+    }
+
+    // zlib stream of stored deflate blocks, at most 65535 bytes each
+    std::vector<std::uint8_t> zlib{0x78, 0x01};
+    std::uint32_t adler_a{1}, adler_b{0};
+
+    for (std::size_t offset{}; offset < raw.size() || raw.empty(); )
+    {
+        std::size_t block{std::min<std::size_t>(65535, raw.size() - offset)};
+        bool last{offset + block == raw.size()};
+
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((std::uint8_t)block);
+        zlib.push_back((std::uint8_t)(block >> 8));
+        zlib.push_back((std::uint8_t)~block);
+        zlib.push_back((std::uint8_t)(~block >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+
+        for (std::size_t i{offset}; i < offset + block; i++)
+        {
+            adler_a = (adler_a + raw[i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+
+        offset += block;
+
+        if (last)
+            break;
+    }
+
+    put_u32(zlib, (adler_b << 16) | adler_a);
+
+    std::vector<std::uint8_t> header{};
+    put_u32(header, (std::uint32_t)width);
+    put_u32(header, (std::uint32_t)height);
+
+    // 8 bits per channel, truecolor, default compression, filter and no interlace
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+
+    std::vector<std::uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib);
+    put_chunk(png, "IEND", {});
+
+    std::ofstream file{path, std::ios::binary};
+
+    if (file.fail())
+    {
+        std::cout << "ERROR::IMAGE::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    file.write((const char *)png.data(), png.size());
+
+    return !file.fail();
+}
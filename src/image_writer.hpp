@@ -0,0 +1,12 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+// to write tightly packed 8-bit RGB pixels as a PNG, rows bottom-up as glReadPixels returns them.
+// the image is stored uncompressed, so no zlib is needed
+bool write_png(const std::string &path, int width, int height, const std::vector<std::uint8_t> &rgb);
+
+#endif //IMAGE_WRITER_H
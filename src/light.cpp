@@ -1,43 +1,48 @@
 #include "light.hpp"
+#include "profiler.hpp"
 
-light::light(shader &a_shader, int r_width, int r_height, glm::vec3 a_pos, glm::vec3 a_color)
-    : l_shader(a_shader), render_width(r_width), render_height(r_height), pos(a_pos), color(a_color)
+light::light(shader &a_shader, const mesh &a_mesh, glm::vec3 a_pos, glm::vec3 a_color)
+    : l_shader(a_shader), l_mesh(a_mesh), pos(a_pos), color(a_color)
 {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+    model_uniform = l_shader.get_uniform<glm::mat4>("model");
+    color_uniform = l_shader.get_uniform<glm::vec3>("light_color");
+}
+
+aabb light::get_bounds() const
+{
+    // the gizmo is the unit cube mesh scaled by 16 around 16 * pos, see apply_uniforms
+    const aabb &local{l_mesh.get_bounds()};
+
+    return aabb{(pos + local.min) * 16.0f, (pos + local.max) * 16.0f};
+}
+
+void light::submit(render_queue &queue, unsigned int condition)
+{
+    PROFILE_SCOPE("light::submit");
+
+    render_packet packet{};
 
-    // bind vertex buffer and vertex array
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    packet.key = queue.make_key(render_pass::opaque, l_shader, 0, l_mesh.get_vao(), queue.depth_of(pos * 16.0f));
+    packet.program = &l_shader;
+    packet.VAO = l_mesh.get_vao();
+    packet.vertex_count = l_mesh.get_index_count();
+    packet.index_type = l_mesh.get_index_type();
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    packet.prepare = [](void *object) {static_cast<light *>(object)->apply_uniforms();};
+    packet.object = this;
+    packet.condition = condition;
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    queue.submit(packet);
 }
 
-void light::draw(glm::vec3 &view_pos)
+void light::apply_uniforms()
 {
-    l_shader.use();
-    l_shader.set_vec3("light_color", color);
+    l_shader.set(color_uniform, color);
 
     glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 view = glm::mat4(1.0f);
-    glm::mat4 projection = glm::mat4(1.0f);
 
     model = glm::scale(model, glm::vec3(16.0f));
     model = glm::translate(model, pos);
 
-    view = glm::lookAt(view_pos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-
-    // projection = glm::perspective(glm::radians(45.0f), (float)render_width / (float)render_height, 0.1f, 100.0f);
-    projection = glm::ortho(-(float)render_width / 2, (float)render_width / 2, -(float)render_height / 2, (float)render_height / 2, -100.0f, 100.0f);
-
-    l_shader.set_mat4("model", model);
-    l_shader.set_mat4("view", view);
-    l_shader.set_mat4("projection", projection);
-
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    l_shader.set(model_uniform, model);
+}
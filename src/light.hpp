@@ -1,7 +1,9 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "mesh.hpp"
 #include "shader.hpp"
+#include "render_queue.hpp"
 
 #ifndef LIGHT_H
 #define LIGHT_H
@@ -9,8 +11,14 @@
 class light
 {
 public:
-    light(shader &a_shader, int r_width, int r_height, glm::vec3 a_pos, glm::vec3 a_color);
-    void draw(glm::vec3 &view_pos);
+    light(shader &a_shader, const mesh &a_mesh, glm::vec3 a_pos, glm::vec3 a_color);
+
+    // to submit the gizmo, camera comes from the per-frame uniform block.
+    // a non-zero condition is the occlusion query the draw waits on
+    void submit(render_queue &queue, unsigned int condition = 0);
+
+    // the world space box around the gizmo
+    aabb get_bounds() const;
     
     glm::vec3 &get_pos(){return pos;};
     glm::vec3 &get_color(){return color;};
@@ -21,64 +29,19 @@ public:
     void translate(glm::vec3 dir){pos += dir;};
 
 private:
+    // to set the gizmo's model and color uniforms once its program is in use
+    void apply_uniforms();
+
     shader &l_shader;
 
-    int render_width, render_height;
+    // the gizmo shares the indexed cube mesh, the light shader only reads its positions
+    const mesh &l_mesh;
 
-    unsigned int VAO{}, VBO{};
+    // uniform handles resolved once at construction
+    uniform<glm::mat4> model_uniform{};
+    uniform<glm::vec3> color_uniform{};
 
     glm::vec3 pos{0.0f};
     glm::vec3 color{1.0f};
-    
-    const float vertices[108]
-    {
-        // Back face
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-        -0.5f,  0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-
-        // Front face
-        -0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        -0.5f, -0.5f,  0.5f,
-
-        // Left face
-        -0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f, -0.5f,
-        -0.5f, -0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-
-        // Right face
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-
-        // Bottom face
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-        -0.5f, -0.5f,  0.5f,
-        -0.5f, -0.5f, -0.5f,
-
-        // Top face
-        -0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-         0.5f,  0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f, -0.5f
-    };  
 };
-#endif //LIGHT_H
\ No newline at end of file
+#endif //LIGHT_H
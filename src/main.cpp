@@ -1,4 +1,7 @@
 #include <string>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -7,9 +10,19 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "shader.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
+#include "gl_trace.hpp"
+#include "frame_stats.hpp"
+#include "alloc_tracker.hpp"
+#include "frame_pacing.hpp"
+#include "gl_handle.hpp"
+#include "gl_state.hpp"
 #include "cube.hpp"
 #include "light.hpp"
+#include "renderer.hpp"
+#include "image_writer.hpp"
+#include "window.hpp"
 
 #define RENDER_WIDTH 320
 #define RENDER_HEIGHT 180
@@ -19,209 +32,510 @@
 #define SCREEN_WIDTH (RENDER_WIDTH * SCALE)
 #define SCREEN_HEIGHT (RENDER_HEIGHT * SCALE)
 
-//shader paths
-const char *LIGHT_VERTEX_SHADER_PATH = "shaders/light_vert.glsl";
-const char *LIGHT_FRAGMENT_SHADER_PATH = "shaders/light_frag.glsl";
+// simulation speeds per second, the old per frame steps at 60 fps
+#define ORBIT_SPEED 60.0f
+#define LIGHT_SPEED 6000.0f
 
-const char *CUBE_VERTEX_SHADER_PATH = "shaders/cube_vert.glsl";
-const char *CUBE_FRAGMENT_SHADER_PATH = "shaders/cube_frag.glsl";
+// longest an idle on-demand loop sleeps before checking the scene again
+#define ON_DEMAND_IDLE_TIMEOUT 1.0
 
-const char *FB_VERTEX_SHADER_PATH = "shaders/framebuffer_vert.glsl";
-const char *FB_FRAGMENT_SHADER_PATH = "shaders/framebuffer_frag.glsl";
+// where F9 and exiting write the last PROFILE_FRAMES frames, when built with OXIDIZER_PROFILE
+#define PROFILE_TRACE_PATH "trace.json"
 
+// where exiting writes per entry point GL call totals, when built with OXIDIZER_GL_TRACE
+#define GL_TRACE_PATH "gl_calls.csv"
+
+// where exiting writes the windowed loop's frame times and hitches
+#define FRAME_STATS_CSV_PATH "frame_stats.csv"
+#define FRAME_STATS_JSON_PATH "frame_stats.json"
+
+// command line options, windowed and interactive unless --headless is given
+struct options
+{
+    bool headless{false};
+    int frames{300};
+    std::string output{"frame.png"};
+    std::string timings{"timings.json"};
+
+    // present intervals longer than this count as hitches
+    double hitch_ms{33.3};
+
+    // headless frames from this one on fail the run if they allocate, negative to allow allocations
+    int no_alloc_after{-1};
+
+    // simulation ticks per second, the windowed frame rate cap (zero for none) and the swap interval
+    double tick_rate{60.0};
+    double fps{0.0};
+    vsync_mode vsync{vsync_mode::on};
+
+    // only render when something changed, otherwise sleep until an event
+    bool on_demand{false};
+
+    // hardware occlusion queries for mesh objects and light gizmos
+    occlusion_query_mode queries{occlusion_query_mode::off};
+};
+
+// what the keys ask for, sampled once per frame and applied on every tick
+struct input_state
+{
+    // +1 orbits one way, -1 the other
+    int orbit{0};
+    bool move_light{false};
+};
+
+// everything the fixed timestep advances, two of these are interpolated for rendering
+struct sim_state
+{
+    float angle{0.0f};
+    glm::vec3 light_pos{0.0f};
+};
+
+// to parse --headless, --frames N, --output path.png and --timings path.json
+bool parse_options(int argc, char **argv, options &opts)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg{argv[i]};
+        bool has_value{i + 1 < argc};
+
+        if (arg == "--headless")
+            opts.headless = true;
+        else if (arg == "--frames" && has_value)
+            opts.frames = std::atoi(argv[++i]);
+        else if (arg == "--output" && has_value)
+            opts.output = argv[++i];
+        else if (arg == "--timings" && has_value)
+            opts.timings = argv[++i];
+        else if (arg == "--hitch-ms" && has_value)
+            opts.hitch_ms = std::atof(argv[++i]);
+        else if (arg == "--assert-no-alloc" && has_value)
+            opts.no_alloc_after = std::atoi(argv[++i]);
+        else if (arg == "--tick-rate" && has_value)
+            opts.tick_rate = std::atof(argv[++i]);
+        else if (arg == "--fps" && has_value)
+            opts.fps = std::atof(argv[++i]);
+        else if (arg == "--vsync" && has_value && parse_vsync(argv[i + 1], opts.vsync))
+            i++;
+        else if (arg == "--on-demand")
+            opts.on_demand = true;
+        else if (arg == "--occlusion-queries" && has_value && parse_occlusion_query_mode(argv[i + 1], opts.queries))
+            i++;
+        else
+        {
+            std::cout << "usage: oxidizer [--headless] [--frames N] [--output frame.png] [--timings timings.json] [--hitch-ms MS] [--assert-no-alloc WARMUP_FRAMES] "
+                         "[--tick-rate HZ] [--fps N] [--vsync off|on|adaptive] [--on-demand] "
+                         "[--occlusion-queries off|conditional|latent]" << std::endl;
+            return false;
+        }
+    }
+
+    if (opts.frames < 1)
+        opts.frames = 1;
+
+    if (opts.tick_rate <= 0.0)
+        opts.tick_rate = 60.0;
+
+    return true;
+}
+
+// set when the window's contents were lost or resized, the last frame has to be presented again
+static bool window_damaged{true};
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and
     // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    gl_state::get().viewport(0, 0, width, height);
+    window_damaged = true;
+}
+
+void window_refresh_callback(GLFWwindow *)
+{
+    window_damaged = true;
 }
 
 // key callback script
-void key_callback(GLFWwindow *window, glm::vec3 &view_pos, float &angle, light a_light)
+void key_callback(GLFWwindow *window, input_state &input, gpu_profiler &a_gpu_profiler)
 {
-    int rad = 3;
+    PROFILE_SCOPE("input");
+
+    // dumps once per press, not every frame the key is held
+    static bool dump_held{false};
+    bool dump_pressed{glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS};
+    if (dump_pressed && !dump_held)
+        PROFILE_DUMP(PROFILE_TRACE_PATH);
+    dump_held = dump_pressed;
+
+    // F10 toggles timing every draw on the gpu, not just the passes
+    static bool per_draw_held{false};
+    bool per_draw_pressed{glfwGetKey(window, GLFW_KEY_F10) == GLFW_PRESS};
+    if (per_draw_pressed && !per_draw_held)
+        a_gpu_profiler.set_per_draw(!a_gpu_profiler.get_per_draw());
+    per_draw_held = per_draw_pressed;
 
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    input.orbit = 0;
+
     if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
     {
-        angle += 1;
+        input.orbit += 1;
     }
 
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
     {
-        angle -= 1;
+        input.orbit -= 1;
     }
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-    {
-        a_light.translate(glm::vec3(0.0f, 0.0f, 100.0f));
-    }   
-
-    view_pos.x = rad * std::cos(glm::radians(angle));
-    view_pos.z = rad * std::sin(glm::radians(angle));
-    view_pos.y = rad;
-    
+    input.move_light = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
 }
 
-int main()
+// to print the cube under the cursor on a left click
+void pick_callback(GLFWwindow *window, const renderer &a_renderer)
 {
-    // GLFW initialization
-    std::cout << "initializing GLFW..." << std::endl;
-    if (!glfwInit())
+    static bool pick_held{false};
+    bool pick_pressed{glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS};
+
+    if (pick_pressed && !pick_held)
     {
-        std::cout << "GLFW initialization failed!" << std::endl;
-        return -1;
+        double x{}, y{};
+        glfwGetCursorPos(window, &x, &y);
+
+        int width{}, height{};
+        glfwGetWindowSize(window, &width, &height);
+
+        int picked{a_renderer.pick(x, y, width, height)};
+        if (picked < 0)
+            std::cout << "picked nothing" << std::endl;
+        else
+            std::cout << "picked cube " << picked << std::endl;
     }
-    std::cout << "GLFW initialized!" << std::endl;
-
-    // GLFW window hints
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
-#endif
-    std::cout << "window hints passed!" << std::endl;
-
-    // creating a window
-    std::cout << "creating a GLFW window..." << std::endl;
-    GLFWwindow *window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "", NULL, NULL);
-    if (window == NULL)
+
+    pick_held = pick_pressed;
+}
+
+// to advance the simulation by one tick, so its speed doesn't depend on the frame rate
+void simulate(sim_state &state, const input_state &input, float dt)
+{
+    state.angle += input.orbit * ORBIT_SPEED * dt;
+
+    if (input.move_light)
+        state.light_pos.z += LIGHT_SPEED * dt;
+}
+
+// to total the gpu time of the outermost passes, from the newest frame the gpu profiler resolved.
+// negative without OXIDIZER_PROFILE, when no passes are timed
+double passes_gpu_ms(const gpu_profiler &a_gpu_profiler)
+{
+    double total{-1.0};
+
+    for (const gpu_timing &timing : a_gpu_profiler.get_results())
     {
-        std::cout << "failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+        if (timing.depth == 0)
+            total = std::max(total, 0.0) + timing.ms;
     }
-    std::cout << "GLFW window created!" << std::endl;
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
-    // GLAD initialization (loading openGL function pointers)
-    std::cout << "initializing GLAD..." << std::endl;
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    return total;
+}
+
+// to write per-frame timings in milliseconds, gpu times are negative if a query wasn't available
+bool write_timings(const std::string &path, const std::vector<double> &cpu_ms, const std::vector<double> &gpu_ms)
+{
+    std::ofstream file{path};
+    if (!file)
     {
-        std::cout << "GLAD initialization failed!" << std::endl;
-        return -1;
+        std::cout << "ERROR::TIMINGS::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
     }
-    std::cout << "GLAD initialized" << std::endl;
 
-    glEnable(GL_DEPTH_TEST);
+    file << "{\n";
+    file << "  \"width\": " << RENDER_WIDTH << ",\n";
+    file << "  \"height\": " << RENDER_HEIGHT << ",\n";
+    file << "  \"frames\": " << cpu_ms.size() << ",\n";
+    file << "  \"renderer\": \"" << (const char *)glGetString(GL_RENDERER) << "\",\n";
 
-    shader l_program{LIGHT_VERTEX_SHADER_PATH, LIGHT_FRAGMENT_SHADER_PATH};
+    file << "  \"cpu_ms\": [";
+    for (std::size_t i = 0; i < cpu_ms.size(); i++)
+        file << (i ? ", " : "") << cpu_ms[i];
+    file << "],\n";
 
-    shader c_program{CUBE_VERTEX_SHADER_PATH, CUBE_FRAGMENT_SHADER_PATH};
+    file << "  \"gpu_ms\": [";
+    for (std::size_t i = 0; i < gpu_ms.size(); i++)
+        file << (i ? ", " : "") << gpu_ms[i];
+    file << "]\n";
 
-    std::vector<cube> cubes;
+    file << "}\n";
 
-    cubes.push_back(cube{c_program, RENDER_WIDTH, RENDER_HEIGHT, glm::vec3(-2.0f,  0.0f,  2.0f), glm::vec3(1.0f, 0.0f, 0.0f)});
-    cubes.push_back(cube{c_program, RENDER_WIDTH, RENDER_HEIGHT, glm::vec3(-2.0f,  0.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f)});
-    cubes.push_back(cube{c_program, RENDER_WIDTH, RENDER_HEIGHT, glm::vec3( 2.0f,  0.0f,  2.0f), glm::vec3(0.0f, 0.0f, 1.0f)});
+    return true;
+}
+
+// to render a fixed number of frames along a scripted orbit, then save the last one and the timings
+int run_headless(renderer &a_renderer, const options &opts)
+{
+    std::vector<query> gpu_queries{};
+    std::vector<double> cpu_ms(opts.frames);
+    std::vector<double> gpu_ms(opts.frames, -1.0);
 
-    shader fb_program{FB_VERTEX_SHADER_PATH, FB_FRAGMENT_SHADER_PATH};
+    for (int i = 0; i < opts.frames; i++)
+        gpu_queries.push_back(query::create());
+
+    float angle{0.0f};
 
-    float quad_vertices[] = 
+    for (int frame = 0; frame < opts.frames; frame++)
     {
-        // positions   // tex_coords
-        -1.0f,  1.0f,  0.0f, 1.0f,
-        -1.0f, -1.0f,  0.0f, 0.0f,
-         1.0f, -1.0f,  1.0f, 0.0f,
+        g_render_stats.reset();
 
-        -1.0f,  1.0f,  0.0f, 1.0f,
-         1.0f, -1.0f,  1.0f, 0.0f,
-         1.0f,  1.0f,  1.0f, 1.0f
-    };
+        auto start = std::chrono::steady_clock::now();
 
-    unsigned int quadVAO, quadVBO;
+        // once warmed up, every buffer the frame needs already has its capacity
+        alloc_tracker::get().set_forbidden(opts.no_alloc_after >= 0 && frame >= opts.no_alloc_after);
 
-    glGenVertexArrays(1, &quadVAO);
-    glGenBuffers(1, &quadVBO);
+        a_renderer.get_camera().orbit(angle, 3.0f);
 
-    glBindVertexArray(quadVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBeginQuery(GL_TIME_ELAPSED, gpu_queries[frame].get());
+        a_renderer.render();
+        glEndQuery(GL_TIME_ELAPSED);
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(quad_vertices), &quad_vertices, GL_STATIC_DRAW);
+        alloc_tracker::get().set_forbidden(false);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+        if (alloc_tracker::enabled() && frame == opts.frames - 1)
+            std::cout << "last frame: " << alloc_tracker::get().frame_summary() << std::endl;
+        alloc_tracker::get().end_frame();
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+        profile_render_stats();
+        PROFILE_FRAME();
 
-    fb_program.use();
-    fb_program.set_int("screen_texture", 0);
+        if (gl_trace::get().is_installed() && frame == opts.frames - 1)
+            std::cout << "last frame: " << gl_trace::get().frame_summary() << std::endl;
+        gl_trace::get().end_frame();
 
-    unsigned int FBO;
-    glGenFramebuffers(1, &FBO);
-    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        auto end = std::chrono::steady_clock::now();
+        cpu_ms[frame] = std::chrono::duration<double, std::milli>(end - start).count();
 
-    unsigned int texture_colorbuffer;
-    glGenTextures(1, &texture_colorbuffer);
-    glBindTexture(GL_TEXTURE_2D, texture_colorbuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, RENDER_WIDTH, RENDER_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture_colorbuffer, 0);
+        angle += 1.0f;
+    }
+
+    // results are only read back once every frame is submitted, so the queries never stall the loop
+    glFinish();
+
+    for (int frame = 0; frame < opts.frames; frame++)
+    {
+        GLint available{};
+        glGetQueryObjectiv(gpu_queries[frame].get(), GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 elapsed{};
+        glGetQueryObjectui64v(gpu_queries[frame].get(), GL_QUERY_RESULT, &elapsed);
+        gpu_ms[frame] = elapsed / 1.0e6;
+    }
 
-    unsigned int RBO;
-    glGenRenderbuffers(1, &RBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, RENDER_WIDTH, RENDER_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, RBO);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    std::vector<std::uint8_t> pixels{};
+    a_renderer.read_pixels(pixels);
 
-    glm::vec3 view_pos{3.0f, 3.0f, 3.0f};
+    bool written{write_png(opts.output, RENDER_WIDTH, RENDER_HEIGHT, pixels)};
+    written = write_timings(opts.timings, cpu_ms, gpu_ms) && written;
 
-    float angle{0.0f};
+    if (written)
+        std::cout << "wrote " << opts.output << " and " << opts.timings << std::endl;
 
-    light a_light{l_program, RENDER_WIDTH, RENDER_HEIGHT, glm::vec3(0.0, 0.0f, 0.0f), glm::vec3(1.0f)};
+    std::cout << "frame arena high water: " << a_renderer.get_arena().get_high_water() << " bytes" << std::endl;
 
-    // render loop
-    while (!glfwWindowShouldClose(window))
+    if (opts.no_alloc_after >= 0 && !alloc_tracker::enabled())
+        std::cout << "--assert-no-alloc needs a build with OXIDIZER_ALLOC_TRACK, allocations weren't checked" << std::endl;
+
+    if (alloc_tracker::get().get_violations() != 0)
     {
-        // process inputs
-        key_callback(window, view_pos, angle, a_light);
+        std::cout << "ERROR::ALLOC_TRACKER::STEADY_STATE_ALLOCATIONS: " << alloc_tracker::get().get_violations()
+                  << " allocations after frame " << opts.no_alloc_after << std::endl;
+        return -1;
+    }
 
-        // clear screen
-        glViewport(0, 0, RENDER_WIDTH, RENDER_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    return written ? 0 : -1;
+}
 
-        glEnable(GL_DEPTH_TEST);
+int main(int argc, char **argv)
+{
+    options opts{};
+    if (!parse_options(argc, argv, opts))
+        return -1;
+
+    GLFWwindow *window = open_window(SCREEN_WIDTH, SCREEN_HEIGHT, opts.headless);
+    if (window == NULL)
+        return -1;
+
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+
+    int result{0};
+
+    // every GL object below is owned by a handle, this scope ends before the context is destroyed
+    {
+        renderer a_renderer{RENDER_WIDTH, RENDER_HEIGHT};
+        a_renderer.set_occlusion_queries(opts.queries);
+
+        mesh_id cube_mesh{a_renderer.get_cube_mesh()};
+
+        a_renderer.get_cubes().add(cube{glm::vec3(-2.0f,  0.0f,  2.0f), 32.0f, glm::vec3(1.0f, 0.0f, 0.0f), cube_mesh});
+        a_renderer.get_cubes().add(cube{glm::vec3(-2.0f,  0.0f, -2.0f), 32.0f, glm::vec3(0.0f, 1.0f, 0.0f), cube_mesh});
+        a_renderer.get_cubes().add(cube{glm::vec3( 2.0f,  0.0f,  2.0f), 32.0f, glm::vec3(0.0f, 0.0f, 1.0f), cube_mesh});
 
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        light &a_light{a_renderer.add_light(glm::vec3(0.0, 0.0f, 0.0f), glm::vec3(1.0f))};
 
-        // draw cube to framebuffer
-        for (cube a_cube : cubes)
+        if (opts.headless)
+            result = run_headless(a_renderer, opts);
+
+        // to report uniform traffic in the window title about once a second
+        double last_title_time{glfwGetTime()};
+
+        frame_stats stats{opts.hitch_ms};
+        double last_present_time{glfwGetTime()};
+
+        input_state input{};
+
+        // the last two ticks, rendering interpolates between them
+        sim_state previous{};
+        sim_state current{};
+
+        fixed_timestep timestep{opts.tick_rate};
+        frame_limiter limiter{opts.fps};
+        double last_frame_time{glfwGetTime()};
+
+        if (!opts.headless && set_vsync(opts.vsync) != opts.vsync)
+            std::cout << "adaptive vsync isn't supported, using vsync" << std::endl;
+
+        // render loop
+        while (!opts.headless && !glfwWindowShouldClose(window))
+        {
+            double frame_start_time{glfwGetTime()};
+
+            // process inputs
+            key_callback(window, input, a_renderer.get_gpu_profiler());
+            pick_callback(window, a_renderer);
+
+            // simulate whole ticks for the time that passed, the remainder carries over
+            int ticks{timestep.advance(frame_start_time - last_frame_time)};
+            last_frame_time = frame_start_time;
+
+            for (int tick = 0; tick < ticks; tick++)
+            {
+                previous = current;
+                simulate(current, input, (float)timestep.get_dt());
+            }
+
+            g_render_stats.reset();
+
+            // render between the last two ticks, so motion stays smooth when frames and ticks don't line up
+            float alpha{(float)timestep.get_alpha()};
+            glm::vec3 light_pos{glm::mix(previous.light_pos, current.light_pos, alpha)};
+
+            a_renderer.get_camera().orbit(glm::mix(previous.angle, current.angle, alpha), 3.0f);
+            a_light.set_pos(light_pos);
+
+            bool render_frame{!opts.on_demand || a_renderer.needs_render()};
+
+            // nothing changed and the window still shows the last frame, sleep until an event or the next tick
+            if (!render_frame && !window_damaged)
+            {
+                bool input_held{input.orbit != 0 || input.move_light};
+                double timeout{input_held ? timestep.get_dt() : ON_DEMAND_IDLE_TIMEOUT};
+
+                {
+                    PROFILE_SCOPE("glfwWaitEventsTimeout");
+                    glfwWaitEventsTimeout(timeout);
+                }
+
+                double wake_time{glfwGetTime()};
+                stats.record_skipped((wake_time - frame_start_time) * 1000.0);
+
+                // the idle wait isn't a frame the user saw, so it mustn't count as a hitch
+                last_present_time = wake_time;
+
+                // an idle sleep isn't time to simulate either, or the first input after waking would be applied for
+                // every tick slept through. a wait for the next tick while a key is held is, it's what moves the scene
+                if (!input_held)
+                    last_frame_time = wake_time;
+
+                PROFILE_FRAME();
+                gl_trace::get().end_frame();
+                alloc_tracker::get().end_frame();
+                continue;
+            }
+
+            // a damaged window presents the last render again, the render target still holds it
+            if (render_frame)
+                a_renderer.render();
+            else
+                stats.record_represented();
+
+            a_renderer.present(SCREEN_WIDTH, SCREEN_HEIGHT);
+            window_damaged = false;
+
+            profile_render_stats();
+
+            if (glfwGetTime() - last_title_time >= 1.0)
+            {
+                std::string title{"uniform bytes/frame: " + std::to_string(g_render_stats.uniform_bytes) +
+                                  "  draw calls: " + std::to_string(g_render_stats.draw_calls) +
+                                  "  draws skipped: " + std::to_string(g_render_stats.draws_skipped) +
+                                  "  occluded results: " + std::to_string(g_render_stats.occluded_results) +
+                                  "  p99 frame: " + std::to_string(stats.get_percentiles(&frame_sample::present_ms).p99) + " ms" +
+                                  "  skipped frames: " + std::to_string(stats.get_skipped_frames())};
+                glfwSetWindowTitle(window, title.c_str());
+                last_title_time = glfwGetTime();
+
+                if (gl_trace::get().is_installed())
+                    std::cout << gl_trace::get().frame_summary() << std::endl;
+
+                if (alloc_tracker::enabled())
+                    std::cout << alloc_tracker::get().frame_summary() << std::endl;
+            }
+
+            double cpu_ms{(glfwGetTime() - frame_start_time) * 1000.0};
+
+            {
+                PROFILE_SCOPE("frame_limiter");
+                limiter.wait();
+            }
+
+            // swap buffers and poll events
+            {
+                PROFILE_SCOPE("glfwSwapBuffers");
+                glfwSwapBuffers(window);
+            }
+
+            {
+                PROFILE_SCOPE("glfwPollEvents");
+                glfwPollEvents();
+            }
+
+            // the present interval is the frame time the user sees, vsync waits included
+            double present_time{glfwGetTime()};
+            stats.record(cpu_ms, passes_gpu_ms(a_renderer.get_gpu_profiler()), (present_time - last_present_time) * 1000.0);
+            last_present_time = present_time;
+
+            PROFILE_FRAME();
+            gl_trace::get().end_frame();
+            alloc_tracker::get().end_frame();
+        }
+
+        PROFILE_DUMP(PROFILE_TRACE_PATH);
+
+        if (gl_trace::get().is_installed())
+            gl_trace::get().write_csv(GL_TRACE_PATH);
+
+        if (!opts.headless)
         {
-            a_cube.draw(a_light.get_color(), a_light.get_pos(), view_pos);
-        };
-
-        a_light.draw(view_pos);
-
-        glBindVertexArray(0);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-        glBlitFramebuffer
-        (
-            0, 0, RENDER_WIDTH, RENDER_HEIGHT,
-            0, 0, SCREEN_WIDTH, SCREEN_HEIGHT,
-            GL_COLOR_BUFFER_BIT, GL_NEAREST
-        );
-
-        // swap buffers and poll events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+            stats.write_csv(FRAME_STATS_CSV_PATH);
+            stats.write_json(FRAME_STATS_JSON_PATH);
+        }
     }
 
     // terminate GLFW
     std::cout << "terminating GLFW..." << std::endl;
     glfwTerminate();
     std::cout << "GLFW terminated!" << std::endl;
-}
 
+    return result;
+}
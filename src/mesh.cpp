@@ -0,0 +1,78 @@
+#include "mesh.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+
+mesh::mesh(const mesh_data &data, vertex_format a_format)
+    : VAO(vertex_array::create()), VBO(buffer::create()), EBO(buffer::create()),
+      vertex_count((GLsizei)data.vertex_count()), index_count((GLsizei)data.indices.size()),
+      format(std::move(a_format))
+{
+    // positions are the first three floats of every vertex
+    for (std::size_t i{}; i < data.vertex_count(); i++)
+    {
+        glm::vec3 position{data.vertices[i * data.stride], data.vertices[i * data.stride + 1], data.vertices[i * data.stride + 2]};
+
+        bounds.min = i ? glm::min(bounds.min, position) : position;
+        bounds.max = i ? glm::max(bounds.max, position) : position;
+    }
+
+    std::vector<std::uint8_t> encoded{};
+    format.encode(data.vertices.data(), data.vertex_count(), data.stride, encoded);
+    format.release_scratch();
+
+    gl_state::get().bind_vertex_array(VAO.get());
+    gl_state::get().bind_buffer(GL_ARRAY_BUFFER, VBO.get());
+
+    glBufferData(GL_ARRAY_BUFFER, encoded.size(), encoded.data(), GL_STATIC_DRAW);
+
+    gl_state::get().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+
+    // half the index memory and bandwidth whenever the vertex count allows it
+    if (data.vertex_count() <= 0xFFFF)
+    {
+        std::vector<std::uint16_t> short_indices(data.indices.begin(), data.indices.end());
+
+        index_type = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, short_indices.size() * sizeof(std::uint16_t), short_indices.data(), GL_STATIC_DRAW);
+    }
+    else
+    {
+        index_type = GL_UNSIGNED_INT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(std::uint32_t), data.indices.data(), GL_STATIC_DRAW);
+    }
+
+    bind_attributes();
+
+    g_render_stats.meshes_uploaded++;
+
+    gl_state::get().bind_vertex_array(0);
+}
+
+void mesh::bind_attributes() const
+{
+    gl_state::get().bind_buffer(GL_ARRAY_BUFFER, VBO.get());
+
+    // the element array binding is recorded in the bound vertex array
+    gl_state::get().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+
+    format.apply();
+}
+
+mesh_id mesh_registry::add(std::string_view name, mesh &&a_mesh)
+{
+    meshes.push_back(std::move(a_mesh));
+    names.emplace_back(name);
+
+    return (mesh_id)(meshes.size() - 1);
+}
+
+mesh_id mesh_registry::find(std::string_view name) const
+{
+    for (std::size_t i{}; i < names.size(); i++)
+    {
+        if (names[i] == name)
+            return (mesh_id)i;
+    }
+
+    return INVALID_MESH_ID;
+}
@@ -0,0 +1,75 @@
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "bvh.hpp"
+#include "gl_handle.hpp"
+#include "mesh_builder.hpp"
+#include "vertex_format.hpp"
+
+#ifndef MESH_H
+#define MESH_H
+
+// indexed geometry uploaded once and shared by every object that draws it
+class mesh
+{
+public:
+    // vertices are encoded into the given format, indices are stored as 16-bit when every vertex fits, 32-bit otherwise
+    mesh(const mesh_data &data, vertex_format a_format);
+
+    // to point the currently bound vertex array at this mesh's vertex and index buffers
+    void bind_attributes() const;
+
+    unsigned int get_vao() const {return VAO.get();};
+    GLsizei get_vertex_count() const {return vertex_count;};
+    GLsizei get_index_count() const {return index_count;};
+
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    GLenum get_index_type() const {return index_type;};
+
+    // the box around every vertex position, in the mesh's own space
+    const aabb &get_bounds() const {return bounds;};
+
+private:
+    vertex_array VAO{};
+    buffer VBO{};
+    buffer EBO{};
+
+    GLsizei vertex_count{};
+    GLsizei index_count{};
+    GLenum index_type{GL_UNSIGNED_INT};
+
+    aabb bounds{};
+
+    vertex_format format;
+};
+
+// index of a mesh in the registry, small enough to live in every instance record
+using mesh_id = std::uint16_t;
+
+#define INVALID_MESH_ID 0xFFFF
+
+// owns every mesh, objects refer to them by mesh_id
+class mesh_registry
+{
+public:
+    // to add a mesh under a name, returns its id
+    mesh_id add(std::string_view name, mesh &&a_mesh);
+
+    // to look up a mesh by name, INVALID_MESH_ID if there is none
+    mesh_id find(std::string_view name) const;
+
+    // references stay valid as more meshes are added
+    const mesh &get(mesh_id id) const {return meshes[id];};
+
+private:
+    std::deque<mesh> meshes;
+    std::vector<std::string> names;
+};
+
+#endif //MESH_H
@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "mesh_builder.hpp"
+
+mesh_data build_mesh(const float *soup, std::size_t vertex_count, std::size_t stride)
+{
+    mesh_data data{deduplicate_vertices(soup, vertex_count, stride)};
+
+    optimize_vertex_cache(data.indices, data.vertex_count());
+    optimize_vertex_fetch(data);
+
+    return data;
+}
+
+mesh_data deduplicate_vertices(const float *soup, std::size_t vertex_count, std::size_t stride)
+{
+    mesh_data data{};
+    data.stride = stride;
+    data.indices.reserve(vertex_count);
+
+    // vertices are compared bit for bit, hashed by their bytes
+    auto hash_vertex = [stride](const float *vertex)
+    {
+        std::uint64_t hash{14695981039346656037ull};
+
+        for (std::size_t i{}; i < stride; i++)
+        {
+            std::uint32_t bits{};
+            std::memcpy(&bits, &vertex[i], sizeof(bits));
+
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+
+        return hash;
+    };
+
+    std::unordered_multimap<std::uint64_t, std::uint32_t> seen{};
+    seen.reserve(vertex_count);
+
+    for (std::size_t i{}; i < vertex_count; i++)
+    {
+        const float *vertex{soup + i * stride};
+        std::uint64_t hash{hash_vertex(vertex)};
+
+        std::uint32_t index{(std::uint32_t)data.vertex_count()};
+        bool found{false};
+
+        auto range{seen.equal_range(hash)};
+
+        for (auto it{range.first}; it != range.second; ++it)
+        {
+            if (std::memcmp(&data.vertices[it->second * stride], vertex, stride * sizeof(float)) == 0)
+            {
+                index = it->second;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            data.vertices.insert(data.vertices.end(), vertex, vertex + stride);
+            seen.emplace(hash, index);
+        }
+
+        data.indices.push_back(index);
+    }
+
+    return data;
+}
+
+// vertex score from its cache position and the number of triangles still using it
+static float vertex_score(int cache_position, std::uint32_t remaining)
+{
+    if (remaining == 0)
+        return -1.0f;
+
+    float score{};
+
+    if (cache_position >= 0)
+    {
+        // the last triangle's vertices get a fixed score so the next triangle doesn't just reuse its edge
+        if (cache_position < 3)
+            score = 0.75f;
+        else
+            score = std::pow(1.0f - (float)(cache_position - 3) / (VERTEX_CACHE_SIZE - 3), 1.5f);
+    }
+
+    // favour vertices with few triangles left, so they get finished and leave the cache
+    score += 2.0f * std::pow((float)remaining, -0.5f);
+
+    return score;
+}
+
+void optimize_vertex_cache(std::vector<std::uint32_t> &indices, std::size_t vertex_count)
+{
+    std::size_t triangle_count{indices.size() / 3};
+
+    if (triangle_count == 0)
+        return;
+
+    // triangles that use each vertex, as offsets into one flat array
+    std::vector<std::uint32_t> remaining(vertex_count, 0);
+    std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+
+    for (std::uint32_t index : indices)
+        remaining[index]++;
+
+    for (std::size_t v{}; v < vertex_count; v++)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<std::uint32_t> vertex_triangles(indices.size());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+    for (std::size_t t{}; t < triangle_count; t++)
+    {
+        for (std::size_t k{}; k < 3; k++)
+            vertex_triangles[fill[indices[t * 3 + k]]++] = (std::uint32_t)t;
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> score(vertex_count);
+
+    for (std::size_t v{}; v < vertex_count; v++)
+        score[v] = vertex_score(-1, remaining[v]);
+
+    std::vector<float> triangle_score(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+
+    for (std::size_t t{}; t < triangle_count; t++)
+        triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+
+    // most recently used first, with room for the three vertices being pushed
+    std::vector<std::uint32_t> cache{};
+    std::vector<std::uint32_t> next_cache{};
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    next_cache.reserve(VERTEX_CACHE_SIZE + 3);
+
+    std::vector<std::uint32_t> output{};
+    output.reserve(indices.size());
+
+    std::size_t scan_start{};
+
+    for (std::size_t emitted_count{}; emitted_count < triangle_count; emitted_count++)
+    {
+        // best triangle touching the cache, the cache holds every candidate worth looking at
+        std::int64_t best{-1};
+        float best_score{-1.0f};
+
+        for (std::uint32_t v : cache)
+        {
+            for (std::uint32_t i{offsets[v]}; i < offsets[v + 1]; i++)
+            {
+                std::uint32_t t{vertex_triangles[i]};
+
+                if (!emitted[t] && triangle_score[t] > best_score)
+                {
+                    best = t;
+                    best_score = triangle_score[t];
+                }
+            }
+        }
+
+        // nothing in the cache, fall back to the next unemitted triangle
+        if (best < 0)
+        {
+            while (emitted[scan_start])
+                scan_start++;
+
+            best = (std::int64_t)scan_start;
+        }
+
+        emitted[best] = true;
+
+        next_cache.clear();
+
+        for (std::size_t k{}; k < 3; k++)
+        {
+            std::uint32_t v{indices[best * 3 + k]};
+
+            output.push_back(v);
+            next_cache.push_back(v);
+            remaining[v]--;
+        }
+
+        for (std::uint32_t v : cache)
+        {
+            if (v != next_cache[0] && v != next_cache[1] && v != next_cache[2])
+                next_cache.push_back(v);
+        }
+
+        // vertices pushed out of the cache lose their position score
+        for (std::size_t i{VERTEX_CACHE_SIZE}; i < next_cache.size(); i++)
+        {
+            cache_position[next_cache[i]] = -1;
+            score[next_cache[i]] = vertex_score(-1, remaining[next_cache[i]]);
+        }
+
+        if (next_cache.size() > VERTEX_CACHE_SIZE)
+            next_cache.resize(VERTEX_CACHE_SIZE);
+
+        cache.swap(next_cache);
+
+        for (std::size_t i{}; i < cache.size(); i++)
+        {
+            cache_position[cache[i]] = (int)i;
+            score[cache[i]] = vertex_score((int)i, remaining[cache[i]]);
+        }
+
+        // only triangles around cached vertices changed score
+        for (std::uint32_t v : cache)
+        {
+            for (std::uint32_t i{offsets[v]}; i < offsets[v + 1]; i++)
+            {
+                std::uint32_t t{vertex_triangles[i]};
+
+                triangle_score[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+            }
+        }
+    }
+
+    indices.swap(output);
+}
+
+void optimize_vertex_fetch(mesh_data &data)
+{
+    std::size_t vertex_count{data.vertex_count()};
+
+    std::vector<std::uint32_t> remap(vertex_count, 0xFFFFFFFFu);
+    std::vector<float> vertices{};
+    vertices.reserve(data.vertices.size());
+
+    std::uint32_t next{};
+
+    for (std::uint32_t &index : data.indices)
+    {
+        if (remap[index] == 0xFFFFFFFFu)
+        {
+            remap[index] = next++;
+            vertices.insert(vertices.end(), data.vertices.begin() + index * data.stride, data.vertices.begin() + (index + 1) * data.stride);
+        }
+
+        index = remap[index];
+    }
+
+    // vertices no triangle uses are dropped
+    data.vertices.swap(vertices);
+}
+
+float average_cache_miss_ratio(const std::vector<std::uint32_t> &indices, std::size_t vertex_count, std::size_t cache_size)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // the time each vertex entered the FIFO, a vertex is cached while fewer than cache_size misses happened since
+    std::vector<std::size_t> entered(vertex_count, 0);
+    std::vector<bool> cached(vertex_count, false);
+
+    std::size_t misses{};
+
+    for (std::uint32_t index : indices)
+    {
+        if (!cached[index] || misses - entered[index] >= cache_size)
+        {
+            entered[index] = misses;
+            cached[index] = true;
+            misses++;
+        }
+    }
+
+    return (float)misses / (float)(indices.size() / 3);
+}
@@ -0,0 +1,39 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+// post-transform vertex cache size the triangle order is optimized for
+#define VERTEX_CACHE_SIZE 32
+
+// indexed geometry ready to upload, vertices are interleaved floats
+struct mesh_data
+{
+    std::vector<float> vertices{};
+    std::vector<std::uint32_t> indices{};
+
+    // floats per vertex
+    std::size_t stride{};
+
+    std::size_t vertex_count() const {return stride ? vertices.size() / stride : 0;};
+};
+
+// to turn a triangle soup into indexed geometry: duplicate vertices are merged, triangles are
+// reordered for the post-transform vertex cache and vertices are renumbered in first-use order
+mesh_data build_mesh(const float *soup, std::size_t vertex_count, std::size_t stride);
+
+// to merge bit-identical vertices of a triangle soup
+mesh_data deduplicate_vertices(const float *soup, std::size_t vertex_count, std::size_t stride);
+
+// to reorder triangles so recently transformed vertices are reused (Forsyth's linear-speed algorithm)
+void optimize_vertex_cache(std::vector<std::uint32_t> &indices, std::size_t vertex_count);
+
+// to renumber vertices in the order the index buffer first touches them, for fetch locality
+void optimize_vertex_fetch(mesh_data &data);
+
+// average vertex shader invocations per triangle for a FIFO cache of the given size, lower is better
+float average_cache_miss_ratio(const std::vector<std::uint32_t> &indices, std::size_t vertex_count, std::size_t cache_size);
+
+#endif //MESH_BUILDER_H
@@ -0,0 +1,64 @@
+#include "mesh_object.hpp"
+#include "transform.hpp"
+
+mesh_object::mesh_object(shader &a_shader, const mesh &a_mesh, const glm::mat4 &a_model, glm::vec3 a_color)
+    : o_shader(a_shader), o_mesh(a_mesh), color(a_color)
+{
+    model_uniform = o_shader.get_uniform<glm::mat4>("model");
+    // the per-vertex inverse variant the bench compares against has no normal matrix
+    if (o_shader.has_uniform("normal_matrix"))
+        normal_uniform = o_shader.get_uniform<glm::mat3>("normal_matrix");
+    color_uniform = o_shader.get_uniform<glm::vec3>("object_color");
+
+    set_model(a_model);
+}
+
+void mesh_object::set_model(const glm::mat4 &a_model)
+{
+    model = a_model;
+    version++;
+
+    // rotation and uniform scale keep normals perpendicular, the fragment shader renormalizes them
+    if (has_uniform_scale(model))
+        normal = glm::mat3(model);
+    else
+        normal = normal_matrix(model);
+}
+
+aabb mesh_object::get_bounds() const
+{
+    const aabb &local{o_mesh.get_bounds()};
+
+    // the box's half extents go through the absolute linear part, so rotated boxes stay enclosed
+    glm::mat3 linear{model};
+    glm::mat3 abs_linear{glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])};
+
+    glm::vec3 center{glm::vec3(model * glm::vec4(local.center(), 1.0f))};
+    glm::vec3 extent{abs_linear * local.extent()};
+
+    return aabb{center - extent, center + extent};
+}
+
+void mesh_object::submit(render_queue &queue, unsigned int condition)
+{
+    render_packet packet{};
+
+    packet.key = queue.make_key(render_pass::opaque, o_shader, 0, o_mesh.get_vao(), queue.depth_of(glm::vec3(model[3])));
+    packet.program = &o_shader;
+    packet.VAO = o_mesh.get_vao();
+    packet.vertex_count = o_mesh.get_index_count();
+    packet.index_type = o_mesh.get_index_type();
+
+    packet.prepare = [](void *object) {static_cast<mesh_object *>(object)->apply_uniforms();};
+    packet.object = this;
+    packet.condition = condition;
+
+    queue.submit(packet);
+}
+
+void mesh_object::apply_uniforms()
+{
+    o_shader.set(model_uniform, model);
+    o_shader.set(normal_uniform, normal);
+    o_shader.set(color_uniform, color);
+}
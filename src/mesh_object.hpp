@@ -0,0 +1,55 @@
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include "mesh.hpp"
+#include "shader.hpp"
+#include "render_queue.hpp"
+
+#ifndef MESH_OBJECT_H
+#define MESH_OBJECT_H
+
+// a lit mesh with an arbitrary model matrix (rotation, non-uniform scale), drawn one at a time.
+// cubes that only translate and scale uniformly should go through cube_batch instead
+class mesh_object
+{
+public:
+    mesh_object(shader &a_shader, const mesh &a_mesh, const glm::mat4 &a_model, glm::vec3 a_color);
+
+    // to submit the object, camera and lights come from the per-frame uniform block.
+    // a non-zero condition is the occlusion query the draw waits on
+    void submit(render_queue &queue, unsigned int condition = 0);
+
+    // the world space box around the mesh's bounds under the model matrix
+    aabb get_bounds() const;
+
+    const glm::mat4 &get_model() const {return model;};
+
+    // bumped by every change through the setters, to tell whether the object needs drawing again
+    std::uint64_t get_version() const {return version;};
+    glm::vec3 &get_color() {return color;};
+
+    // to change the transform, the normal matrix is recomputed here and not per vertex or per frame
+    void set_model(const glm::mat4 &a_model);
+    void set_color(const glm::vec3 &a_color) {color = a_color; version++;};
+
+private:
+    // to set the model, normal matrix and color uniforms once the program is in use
+    void apply_uniforms();
+
+    shader &o_shader;
+    const mesh &o_mesh;
+
+    // uniform handles resolved once at construction
+    uniform<glm::mat4> model_uniform{};
+    uniform<glm::mat3> normal_uniform{};
+    uniform<glm::vec3> color_uniform{};
+
+    glm::mat4 model{1.0f};
+    glm::mat3 normal{1.0f};
+    glm::vec3 color{1.0f};
+
+    std::uint64_t version{0};
+};
+
+#endif //MESH_OBJECT_H
@@ -0,0 +1,484 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "occlusion_buffer.hpp"
+#include "profiler.hpp"
+
+#if defined(__SSE2__)
+#define OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// corners of a box are numbered by bits, x in bit 0, y in bit 1, z in bit 2.
+// faces are listed counter-clockwise seen from outside, so front faces keep a positive area on screen
+static const int BOX_FACES[6][4]
+{
+    {1, 3, 7, 5}, {0, 4, 6, 2},
+    {2, 6, 7, 3}, {0, 1, 5, 4},
+    {4, 5, 7, 6}, {0, 2, 3, 1}
+};
+
+// std::floor is a libm call without sse4.1, and occluded runs it four times per box
+static int floor_to_int(float value)
+{
+    int truncated{(int)value};
+    return truncated - (value < (float)truncated);
+}
+
+occlusion_buffer::occlusion_buffer(int a_width, int a_height, int threads)
+    : width(a_width), height(a_height), stride((a_width + 3) & ~3)
+{
+    depth.assign((std::size_t)stride * height, 1.0f);
+
+    if (threads <= 0)
+        threads = (int)std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+
+    band_count = std::min(threads, height);
+
+    for (int band = 1; band < band_count; band++)
+        workers.emplace_back(&occlusion_buffer::worker, this, band);
+
+    // every level halves the one before it, rounding up, down to a single texel
+    int level_width{width}, level_height{height};
+    while (true)
+    {
+        pyramid_level level{};
+        level.width = level_width;
+        level.height = level_height;
+        level.min_depth.assign((std::size_t)level_width * level_height, 1.0f);
+        level.max_depth.assign((std::size_t)level_width * level_height, 1.0f);
+        levels.push_back(std::move(level));
+
+        if (level_width == 1 && level_height == 1)
+            break;
+
+        level_width = (level_width + 1) / 2;
+        level_height = (level_height + 1) / 2;
+    }
+
+    shapes.reserve(OCCLUSION_MAX_OCCLUDERS);
+}
+
+occlusion_buffer::~occlusion_buffer()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    start.notify_all();
+
+    for (std::thread &thread : workers)
+        thread.join();
+}
+
+void occlusion_buffer::begin(const glm::mat4 &a_view_projection)
+{
+    view_projection = a_view_projection;
+
+    // an orthographic projection keeps w at 1, so a box's screen bounds are its projected center plus |M| times its extent
+    affine = view_projection[0][3] == 0.0f && view_projection[1][3] == 0.0f &&
+             view_projection[2][3] == 0.0f && view_projection[3][3] == 1.0f;
+
+    for (int column = 0; column < 3; column++)
+        abs_linear[column] = glm::abs(glm::vec3(view_projection[column]));
+
+    shapes.clear();
+    occluder_count = 0;
+}
+
+glm::vec3 occlusion_buffer::to_screen(const glm::vec3 &world_pos) const
+{
+    glm::vec4 clip{view_projection * glm::vec4(world_pos, 1.0f)};
+    glm::vec3 ndc{glm::vec3(clip) / clip.w};
+
+    return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+}
+
+float occlusion_buffer::depth_of(const glm::vec3 &world_pos) const
+{
+    glm::vec4 clip{view_projection * glm::vec4(world_pos, 1.0f)};
+    return clip.z / clip.w * 0.5f + 0.5f;
+}
+
+bool occlusion_buffer::can_occlude(const aabb &box) const
+{
+    // without a constant w every corner has to be projected, add_occluder does that anyway
+    if (!affine)
+        return true;
+
+    glm::vec3 box_center{box.center()}, box_extent{box.extent()};
+
+    float center_z{view_projection[0].z * box_center.x + view_projection[1].z * box_center.y + view_projection[2].z * box_center.z + view_projection[3].z};
+    float extent_z{abs_linear[0].z * box_extent.x + abs_linear[1].z * box_extent.y + abs_linear[2].z * box_extent.z};
+
+    return center_z - extent_z >= -1.0f && center_z + extent_z <= 1.0f;
+}
+
+void occlusion_buffer::add_occluder(const aabb &box)
+{
+    glm::vec3 corners[8]{};
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 world_pos{corner & 1 ? box.max.x : box.min.x,
+                            corner & 2 ? box.max.y : box.min.y,
+                            corner & 4 ? box.max.z : box.min.z};
+
+        glm::vec4 clip{view_projection * glm::vec4(world_pos, 1.0f)};
+
+        // clipping an occluder could only shrink it, dropping it is just as safe
+        if (clip.w <= 0.0f || std::abs(clip.z) > clip.w)
+            return;
+
+        corners[corner] = to_screen(world_pos);
+    }
+
+    screen_occluder shape{};
+
+    // the front surface of a box is convex, so it's the largest of its front face planes,
+    // and its largest value over a pixel is at one of the pixel's corners
+    for (const int (&face)[4] : BOX_FACES)
+    {
+        const glm::vec3 &a{corners[face[0]]};
+        glm::vec3 normal{glm::cross(corners[face[1]] - a, corners[face[2]] - a)};
+
+        // back faces and faces seen edge on
+        if (normal.z <= 0.0f)
+            continue;
+
+        float depth_a{-normal.x / normal.z};
+        float depth_b{-normal.y / normal.z};
+        float depth_c{a.z - depth_a * a.x - depth_b * a.y + 0.5f * (std::abs(depth_a) + std::abs(depth_b))};
+
+        shape.depth[shape.plane_count++] = glm::vec3(depth_a, depth_b, depth_c);
+    }
+
+    if (shape.plane_count == 0)
+        return;
+
+    // the silhouette is the convex hull of the projected corners, counter-clockwise by the monotone chain
+    glm::vec2 points[8]{};
+    for (int corner = 0; corner < 8; corner++)
+        points[corner] = glm::vec2(corners[corner]);
+
+    std::sort(std::begin(points), std::end(points), [](const glm::vec2 &a, const glm::vec2 &b) {return a.x < b.x || (a.x == b.x && a.y < b.y);});
+
+    auto turn = [](const glm::vec2 &o, const glm::vec2 &a, const glm::vec2 &b) {return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);};
+
+    glm::vec2 hull[16]{};
+    int hull_size{0};
+
+    for (int i = 0; i < 8; i++)
+    {
+        while (hull_size >= 2 && turn(hull[hull_size - 2], hull[hull_size - 1], points[i]) <= 0.0f)
+            hull_size--;
+        hull[hull_size++] = points[i];
+    }
+
+    for (int i = 6, lower_size = hull_size + 1; i >= 0; i--)
+    {
+        while (hull_size >= lower_size && turn(hull[hull_size - 2], hull[hull_size - 1], points[i]) <= 0.0f)
+            hull_size--;
+        hull[hull_size++] = points[i];
+    }
+
+    // the last point closes the loop back to the first
+    hull_size--;
+
+    // a box projects to at most a hexagon
+    if (hull_size < 3 || hull_size > 6)
+        return;
+
+    glm::vec2 hull_min{hull[0]}, hull_max{hull[0]};
+    for (int i = 0; i < hull_size; i++)
+    {
+        const glm::vec2 &from{hull[i]};
+        const glm::vec2 &to{hull[(i + 1) % hull_size]};
+
+        // moving the edge in by half a pixel along each axis leaves only fully covered pixel centers inside
+        float edge_a{from.y - to.y};
+        float edge_b{to.x - from.x};
+        float edge_c{-(edge_a * from.x + edge_b * from.y) - 0.5f * (std::abs(edge_a) + std::abs(edge_b))};
+
+        shape.edge[shape.edge_count++] = glm::vec3(edge_a, edge_b, edge_c);
+
+        hull_min = glm::min(hull_min, from);
+        hull_max = glm::max(hull_max, from);
+    }
+
+    shape.min_x = std::max(0, (int)std::floor(hull_min.x));
+    shape.max_x = std::min(width - 1, (int)std::ceil(hull_max.x));
+    shape.min_y = std::max(0, (int)std::floor(hull_min.y));
+    shape.max_y = std::min(height - 1, (int)std::ceil(hull_max.y));
+
+    if (shape.min_x > shape.max_x || shape.min_y > shape.max_y)
+        return;
+
+    shapes.push_back(shape);
+    occluder_count++;
+}
+
+void occlusion_buffer::rasterize()
+{
+    PROFILE_SCOPE("occlusion_buffer::rasterize");
+
+    if (band_count > 1)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            pending = band_count - 1;
+            generation++;
+        }
+        start.notify_all();
+    }
+
+    rasterize_band(0);
+
+    if (band_count > 1)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [&] {return pending == 0;});
+    }
+
+    build_pyramid();
+}
+
+void occlusion_buffer::worker(int band)
+{
+    std::uint64_t seen{0};
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            start.wait(lock, [&] {return stopping || generation != seen;});
+
+            if (stopping)
+                return;
+
+            seen = generation;
+        }
+
+        rasterize_band(band);
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            pending--;
+        }
+        done.notify_one();
+    }
+}
+
+void occlusion_buffer::rasterize_band(int band)
+{
+    PROFILE_SCOPE("occlusion_buffer::rasterize_band");
+
+    int first_row{band * height / band_count};
+    int last_row{(band + 1) * height / band_count - 1};
+
+    std::fill(depth.begin() + (std::size_t)first_row * stride, depth.begin() + (std::size_t)(last_row + 1) * stride, 1.0f);
+
+    for (const screen_occluder &shape : shapes)
+    {
+        int min_y{std::max(shape.min_y, first_row)};
+        int max_y{std::min(shape.max_y, last_row)};
+
+        // every row starts on a 4 pixel boundary, the padded stride keeps the last group in bounds
+        int min_x{shape.min_x & ~3};
+
+        for (int y = min_y; y <= max_y; y++)
+        {
+            float py{y + 0.5f};
+            float *row{&depth[(std::size_t)y * stride]};
+
+#ifdef OCCLUSION_SSE2
+            const __m128 zero{_mm_setzero_ps()};
+            const __m128 lane_offsets{_mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f)};
+
+            __m128 row_edge[6];
+            __m128 edge_step[6];
+            for (int i = 0; i < shape.edge_count; i++)
+            {
+                row_edge[i] = _mm_set1_ps(shape.edge[i].y * py + shape.edge[i].z);
+                edge_step[i] = _mm_set1_ps(shape.edge[i].x);
+            }
+
+            __m128 row_depth[3];
+            __m128 depth_step[3];
+            for (int i = 0; i < shape.plane_count; i++)
+            {
+                row_depth[i] = _mm_set1_ps(shape.depth[i].y * py + shape.depth[i].z);
+                depth_step[i] = _mm_set1_ps(shape.depth[i].x);
+            }
+
+            for (int x = min_x; x <= shape.max_x; x += 4)
+            {
+                __m128 px{_mm_add_ps(_mm_set1_ps((float)x), lane_offsets)};
+
+                __m128 inside{_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_step[0], px), row_edge[0]), zero)};
+                for (int i = 1; i < shape.edge_count; i++)
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edge_step[i], px), row_edge[i]), zero));
+
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                __m128 shape_depth{_mm_add_ps(_mm_mul_ps(depth_step[0], px), row_depth[0])};
+                for (int i = 1; i < shape.plane_count; i++)
+                    shape_depth = _mm_max_ps(shape_depth, _mm_add_ps(_mm_mul_ps(depth_step[i], px), row_depth[i]));
+
+                __m128 old_depth{_mm_loadu_ps(row + x)};
+                __m128 new_depth{_mm_min_ps(old_depth, shape_depth)};
+
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_depth), _mm_andnot_ps(inside, old_depth)));
+            }
+#else
+            for (int x = min_x; x <= shape.max_x; x++)
+            {
+                float px{x + 0.5f};
+
+                bool inside{true};
+                for (int i = 0; i < shape.edge_count; i++)
+                    inside = inside && shape.edge[i].x * px + shape.edge[i].y * py + shape.edge[i].z >= 0.0f;
+
+                if (!inside)
+                    continue;
+
+                float shape_depth{shape.depth[0].x * px + shape.depth[0].y * py + shape.depth[0].z};
+                for (int i = 1; i < shape.plane_count; i++)
+                    shape_depth = std::max(shape_depth, shape.depth[i].x * px + shape.depth[i].y * py + shape.depth[i].z);
+
+                row[x] = std::min(row[x], shape_depth);
+            }
+#endif
+        }
+    }
+}
+
+void occlusion_buffer::build_pyramid()
+{
+    PROFILE_SCOPE("occlusion_buffer::build_pyramid");
+
+    pyramid_level &base{levels[0]};
+    for (int y = 0; y < height; y++)
+    {
+        std::copy_n(&depth[(std::size_t)y * stride], width, &base.min_depth[(std::size_t)y * width]);
+        std::copy_n(&depth[(std::size_t)y * stride], width, &base.max_depth[(std::size_t)y * width]);
+    }
+
+    for (std::size_t index = 1; index < levels.size(); index++)
+    {
+        const pyramid_level &fine{levels[index - 1]};
+        pyramid_level &coarse{levels[index]};
+
+        for (int y = 0; y < coarse.height; y++)
+        {
+            // an odd last row or column is folded into a single texel
+            int y0{2 * y}, y1{std::min(2 * y + 1, fine.height - 1)};
+
+            for (int x = 0; x < coarse.width; x++)
+            {
+                int x0{2 * x}, x1{std::min(2 * x + 1, fine.width - 1)};
+
+                std::size_t i00{(std::size_t)y0 * fine.width + x0}, i01{(std::size_t)y0 * fine.width + x1};
+                std::size_t i10{(std::size_t)y1 * fine.width + x0}, i11{(std::size_t)y1 * fine.width + x1};
+
+                std::size_t out{(std::size_t)y * coarse.width + x};
+                coarse.min_depth[out] = std::min(std::min(fine.min_depth[i00], fine.min_depth[i01]), std::min(fine.min_depth[i10], fine.min_depth[i11]));
+                coarse.max_depth[out] = std::max(std::max(fine.max_depth[i00], fine.max_depth[i01]), std::max(fine.max_depth[i10], fine.max_depth[i11]));
+            }
+        }
+    }
+}
+
+bool occlusion_buffer::occluded(const aabb &box) const
+{
+    glm::vec3 ndc_min{}, ndc_max{};
+
+    if (affine)
+    {
+        // spelled out by column, this runs for every visible box and glm's matrix products don't inline
+        glm::vec3 box_center{box.center()}, box_extent{box.extent()};
+
+        glm::vec3 center{glm::vec3(view_projection[0]) * box_center.x + glm::vec3(view_projection[1]) * box_center.y +
+                         glm::vec3(view_projection[2]) * box_center.z + glm::vec3(view_projection[3])};
+        glm::vec3 extent{abs_linear[0] * box_extent.x + abs_linear[1] * box_extent.y + abs_linear[2] * box_extent.z};
+
+        ndc_min = center - extent;
+        ndc_max = center + extent;
+    }
+    else
+    {
+        ndc_min = glm::vec3(std::numeric_limits<float>::max());
+        ndc_max = glm::vec3(-std::numeric_limits<float>::max());
+
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec4 clip{view_projection * glm::vec4(corner & 1 ? box.max.x : box.min.x,
+                                                       corner & 2 ? box.max.y : box.min.y,
+                                                       corner & 4 ? box.max.z : box.min.z, 1.0f)};
+            if (clip.w <= 0.0f)
+                return false;
+
+            glm::vec3 ndc{glm::vec3(clip) / clip.w};
+            ndc_min = glm::min(ndc_min, ndc);
+            ndc_max = glm::max(ndc_max, ndc);
+        }
+    }
+
+    // crossing the near plane means the box is partly in front of every occluder
+    if (ndc_min.z < -1.0f)
+        return false;
+
+    float nearest{ndc_min.z * 0.5f + 0.5f};
+
+    int x0{floor_to_int((ndc_min.x * 0.5f + 0.5f) * width)};
+    int x1{floor_to_int((ndc_max.x * 0.5f + 0.5f) * width)};
+    int y0{floor_to_int((ndc_min.y * 0.5f + 0.5f) * height)};
+    int y1{floor_to_int((ndc_max.y * 0.5f + 0.5f) * height)};
+
+    // off screen is the frustum's call, not ours
+    if (x1 < 0 || y1 < 0 || x0 >= width || y0 >= height)
+        return false;
+
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, width - 1);
+    y1 = std::min(y1, height - 1);
+
+    // start where the box covers at most 2x2 texels, refine while it's ambiguous and cheap
+    std::size_t level_index{0};
+    while (level_index + 1 < levels.size() && ((x1 >> level_index) - (x0 >> level_index) > 1 || (y1 >> level_index) - (y0 >> level_index) > 1))
+        level_index++;
+
+    while (true)
+    {
+        const pyramid_level &level{levels[level_index]};
+
+        float region_min{1.0f}, region_max{0.0f};
+        for (int y = y0 >> level_index; y <= y1 >> level_index; y++)
+        {
+            for (int x = x0 >> level_index; x <= x1 >> level_index; x++)
+            {
+                std::size_t i{(std::size_t)y * level.width + x};
+                region_min = std::min(region_min, level.min_depth[i]);
+                region_max = std::max(region_max, level.max_depth[i]);
+            }
+        }
+
+        // behind the farthest occluder everywhere it covers
+        if (nearest > region_max)
+            return true;
+
+        // in front of the nearest occluder everywhere it covers
+        if (nearest <= region_min || level_index == 0)
+            return false;
+
+        level_index--;
+
+        std::size_t texels{(std::size_t)((x1 >> level_index) - (x0 >> level_index) + 1) * ((y1 >> level_index) - (y0 >> level_index) + 1)};
+        if (texels > OCCLUSION_MAX_TEST_TEXELS)
+            return false;
+    }
+}
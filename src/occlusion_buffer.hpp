@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "bvh.hpp"
+
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+// most occluders rasterized per frame, the largest and nearest visible cubes are picked
+#define OCCLUSION_MAX_OCCLUDERS 512
+
+// a finer pyramid level is only tried while a box covers at most this many of its texels
+#define OCCLUSION_MAX_TEST_TEXELS 64
+
+// a low resolution depth buffer the cpu rasterizes occluders into, with min and max depth pyramids
+// over it so boxes can be tested against it before they are drawn. depth is 0 at the near plane.
+// an occluder only covers pixels its silhouette covers completely, at the farthest depth its front faces
+// reach inside the pixel, so a box is only reported hidden if it really is.
+// rows are split into bands, one per thread, so rasterizing needs no locking
+class occlusion_buffer
+{
+public:
+    // threads includes the calling thread, 0 picks from the hardware
+    occlusion_buffer(int a_width, int a_height, int threads = 0);
+    ~occlusion_buffer();
+
+    occlusion_buffer(const occlusion_buffer &) = delete;
+    occlusion_buffer &operator=(const occlusion_buffer &) = delete;
+
+    // to clear the depth and the occluders for a new view
+    void begin(const glm::mat4 &a_view_projection);
+
+    // to queue a box as an occluder, skipped unless it lies fully between the near and far planes
+    void add_occluder(const aabb &box);
+
+    // whether add_occluder would keep the box, cheap enough to rank every candidate with
+    bool can_occlude(const aabb &box) const;
+
+    // to rasterize the queued occluders and build the pyramids
+    void rasterize();
+
+    // whether the box is behind the occluders everywhere it covers on screen
+    bool occluded(const aabb &box) const;
+
+    // to get the depth of a world position, used to prefer near occluders
+    float depth_of(const glm::vec3 &world_pos) const;
+
+    int get_width() const {return width;};
+    int get_height() const {return height;};
+    std::size_t get_occluder_count() const {return occluder_count;};
+
+    // level 0 is the rasterized depth, every level after it halves both sides
+    std::size_t get_level_count() const {return levels.size();};
+
+private:
+    // an occluder's silhouette on screen, set up once and shared by every band.
+    // edges are A x + B y + C, non-negative where a whole pixel is inside. depth is the largest of the
+    // front face planes z = a x + b y + c, each already raised to its farthest pixel corner
+    struct screen_occluder
+    {
+        glm::vec3 edge[6]{};
+        int edge_count{};
+        glm::vec3 depth[3]{};
+        int plane_count{};
+        int min_x{}, max_x{}, min_y{}, max_y{};
+    };
+
+    struct pyramid_level
+    {
+        int width{}, height{};
+        std::vector<float> min_depth{};
+        std::vector<float> max_depth{};
+    };
+
+    // to project a world position to pixels and depth
+    glm::vec3 to_screen(const glm::vec3 &world_pos) const;
+
+    void rasterize_band(int band);
+    void build_pyramid();
+
+    void worker(int band);
+
+    int width, height;
+
+    // level 0 rows are padded to a multiple of 4 floats for the simd rasterizer
+    int stride;
+    std::vector<float> depth{};
+
+    std::vector<pyramid_level> levels{};
+
+    glm::mat4 view_projection{1.0f};
+
+    // |view_projection| in clip x, y, z, so box bounds project without transforming every corner
+    glm::mat3 abs_linear{1.0f};
+    bool affine{true};
+
+    std::vector<screen_occluder> shapes{};
+    std::size_t occluder_count{0};
+
+    // worker pool, band 0 is rasterized on the calling thread
+    int band_count;
+    std::vector<std::thread> workers{};
+    std::mutex mutex{};
+    std::condition_variable start{};
+    std::condition_variable done{};
+    std::uint64_t generation{0};
+    int pending{0};
+    bool stopping{false};
+};
+
+#endif //OCCLUSION_BUFFER_H
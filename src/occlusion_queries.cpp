@@ -0,0 +1,183 @@
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "occlusion_queries.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
+
+const char *occlusion_query_mode_name(occlusion_query_mode mode)
+{
+    switch (mode)
+    {
+        case occlusion_query_mode::conditional: return "conditional";
+        case occlusion_query_mode::latent: return "latent";
+        default: return "off";
+    }
+}
+
+bool parse_occlusion_query_mode(std::string_view name, occlusion_query_mode &mode)
+{
+    for (occlusion_query_mode candidate : {occlusion_query_mode::off, occlusion_query_mode::conditional, occlusion_query_mode::latent})
+    {
+        if (name == occlusion_query_mode_name(candidate))
+        {
+            mode = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+occlusion_queries::occlusion_queries(shader &a_proxy_program, const mesh &a_box_mesh)
+    : proxy_program(a_proxy_program), box_mesh(a_box_mesh)
+{
+    model_uniform = proxy_program.get_uniform<glm::mat4>("model");
+
+    // core in 4.3, a conservative query may pass where a full rasterization wouldn't but never the other way round
+    if (GLAD_GL_VERSION_4_3)
+        target = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+}
+
+std::int32_t occlusion_queries::acquire()
+{
+    if (free_queries.empty())
+    {
+        pool.push_back(query::create());
+        return (std::int32_t)pool.size() - 1;
+    }
+
+    std::int32_t index{free_queries.back()};
+    free_queries.pop_back();
+
+    return index;
+}
+
+bool occlusion_queries::poll()
+{
+    PROFILE_SCOPE("occlusion_queries::poll");
+
+    bool changed{false};
+
+    for (object_state &object : objects)
+    {
+        if (object.pending < 0)
+            continue;
+
+        unsigned int id{pool[object.pending].get()};
+
+        // never wait on the gpu, an unfinished query is read on a later frame
+        GLuint available{};
+        glGetQueryObjectuiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint samples{};
+        glGetQueryObjectuiv(id, GL_QUERY_RESULT, &samples);
+
+        if (!samples)
+            g_render_stats.occluded_results++;
+
+        changed |= object.visible != (samples != 0);
+        object.visible = samples != 0;
+
+        free_queries.push_back(object.pending);
+        object.pending = -1;
+    }
+
+    return changed;
+}
+
+void occlusion_queries::begin(std::size_t count, const glm::mat4 &a_view_projection)
+{
+    PROFILE_SCOPE("occlusion_queries::begin");
+
+    view_projection = a_view_projection;
+
+    // objects are matched by index, removing one shifts the rest so their results no longer apply
+    if (count < objects.size())
+        reset();
+
+    objects.resize(count);
+
+    poll();
+
+    proxy_program.use();
+    gl_state::get().bind_vertex_array(box_mesh.get_vao());
+
+    // proxies only test against the depth, they must not change it or show up
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+}
+
+bool occlusion_queries::test(std::size_t index, const aabb &box)
+{
+    object_state &object{objects[index]};
+    object.condition = 0;
+
+    // a box reaching past the near plane has its front clipped away, the camera may be looking right at it
+    for (int corner{}; corner < 8; corner++)
+    {
+        glm::vec3 position{corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y, corner & 4 ? box.max.z : box.min.z};
+        glm::vec4 clip{view_projection * glm::vec4(position, 1.0f)};
+
+        if (clip.z < -clip.w)
+        {
+            if (object.pending < 0)
+                object.visible = true;
+
+            return true;
+        }
+    }
+
+    // one query per object in flight, a slow gpu keeps the older result a little longer
+    if (object.pending < 0)
+    {
+        object.pending = acquire();
+
+        glm::mat4 model{glm::translate(glm::mat4(1.0f), box.center())};
+        model = glm::scale(model, box.extent() * 2.0f);
+
+        proxy_program.set(model_uniform, model);
+
+        glBeginQuery(target, pool[object.pending].get());
+        glDrawElements(GL_TRIANGLES, box_mesh.get_index_count(), box_mesh.get_index_type(), nullptr);
+        glEndQuery(target);
+
+        g_render_stats.occlusion_queries++;
+    }
+
+    if (mode == occlusion_query_mode::conditional)
+    {
+        object.condition = pool[object.pending].get();
+        return true;
+    }
+
+    if (!object.visible)
+        g_render_stats.draws_skipped++;
+
+    return object.visible;
+}
+
+unsigned int occlusion_queries::condition(std::size_t index) const
+{
+    return objects[index].condition;
+}
+
+void occlusion_queries::end()
+{
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+}
+
+void occlusion_queries::reset()
+{
+    // an unread result is simply dropped, beginning the query again discards it
+    for (object_state &object : objects)
+    {
+        if (object.pending >= 0)
+            free_queries.push_back(object.pending);
+    }
+
+    objects.clear();
+}
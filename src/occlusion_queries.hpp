@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "bvh.hpp"
+#include "gl_handle.hpp"
+#include "mesh.hpp"
+#include "shader.hpp"
+
+#ifndef OCCLUSION_QUERIES_H
+#define OCCLUSION_QUERIES_H
+
+// how objects are tested against the depth buffer before they are drawn
+enum class occlusion_query_mode
+{
+    // every object is drawn
+    off,
+
+    // draws are conditioned on their proxy's query on the gpu, the cpu never waits or skips anything
+    conditional,
+
+    // the cpu skips objects whose proxy drew no samples last time, a frame late so the result is ready
+    latent
+};
+
+// to get the mode's name for logs and results
+const char *occlusion_query_mode_name(occlusion_query_mode mode);
+
+// to look a mode up by name, returns false if there is none
+bool parse_occlusion_query_mode(std::string_view name, occlusion_query_mode &mode);
+
+// hardware occlusion queries on proxy boxes for objects that are expensive to draw.
+// the proxy is a bounding box drawn with color and depth writes off against the depth already in the
+// target, objects are identified by their index in submission order. results are only read once
+// GL_QUERY_RESULT_AVAILABLE says so, an object keeps its previous result until then.
+// query objects come from a pool and go back to it once read, one is in flight per object at most
+class occlusion_queries
+{
+public:
+    // the proxy program only needs a "model" uniform and the per-frame view projection
+    occlusion_queries(shader &a_proxy_program, const mesh &a_box_mesh);
+
+    // to read every finished query, returns whether an object's visibility changed
+    bool poll();
+
+    // to start testing count objects for a view, turns color and depth writes off until end
+    void begin(std::size_t count, const glm::mat4 &a_view_projection);
+
+    // to draw the object's proxy under a query, unless one is still in flight, and return whether to submit it
+    bool test(std::size_t index, const aabb &box);
+
+    // to get the query the object's draw should be conditioned on, 0 to draw unconditionally
+    unsigned int condition(std::size_t index) const;
+
+    // to turn color and depth writes back on
+    void end();
+
+    // to forget every object, queries still in flight go back to the pool
+    void reset();
+
+    void set_mode(occlusion_query_mode a_mode) {mode = a_mode; reset();};
+    occlusion_query_mode get_mode() const {return mode;};
+
+    // query objects created so far, in flight or free
+    std::size_t get_pool_size() const {return pool.size();};
+
+private:
+    struct object_state
+    {
+        // pool index of the query in flight, -1 if there's none
+        std::int32_t pending{-1};
+
+        // the query this frame's draw is conditioned on
+        unsigned int condition{};
+
+        // whether the last finished query drew any samples, objects start visible
+        bool visible{true};
+    };
+
+    // to take a query from the pool, creating one if every query is in flight
+    std::int32_t acquire();
+
+    shader &proxy_program;
+    const mesh &box_mesh;
+
+    uniform<glm::mat4> model_uniform{};
+
+    occlusion_query_mode mode{occlusion_query_mode::off};
+
+    // GL_ANY_SAMPLES_PASSED_CONSERVATIVE where the context has it
+    GLenum target{GL_ANY_SAMPLES_PASSED};
+
+    glm::mat4 view_projection{1.0f};
+
+    std::vector<query> pool{};
+    std::vector<std::int32_t> free_queries{};
+
+    // keeps its capacity, so a steady scene doesn't allocate
+    std::vector<object_state> objects{};
+};
+
+#endif //OCCLUSION_QUERIES_H
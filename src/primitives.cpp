@@ -0,0 +1,72 @@
+#include "primitives.hpp"
+
+const float cube_vertices[216]
+{
+    // Back face
+    -0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+     0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+    -0.5f,  0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+    -0.5f, -0.5f, -0.5f,   0.0f,  0.0f, -1.0f,
+
+    // Front face
+    -0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+     0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+     0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+     0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+    -0.5f,  0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+    -0.5f, -0.5f,  0.5f,   0.0f,  0.0f,  1.0f,
+
+    // Left face
+    -0.5f,  0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f,  -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f,  -1.0f,  0.0f,  0.0f,
+
+    // Right face
+     0.5f,  0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,   1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,   1.0f,  0.0f,  0.0f,
+
+    // Bottom face
+    -0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
+    -0.5f, -0.5f,  0.5f,   0.0f, -1.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f,   0.0f, -1.0f,  0.0f,
+
+    // Top face
+    -0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f,   0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f,   0.0f,  1.0f,  0.0f
+};
+
+mesh make_cube_mesh(bool packed)
+{
+    vertex_format format{};
+
+    // cube corners at +-0.5 and axis normals are exact in both packed types
+    if (packed)
+    {
+        format.add(0, 3, attribute_type::half_float, 0)
+              .add(1, 3, attribute_type::snorm_2_10_10_10, 3);
+    }
+    else
+    {
+        format.add(0, 3, attribute_type::float32, 0)
+              .add(1, 3, attribute_type::float32, 3);
+    }
+
+    // 36 soup vertices become 24 unique ones (4 per face) and 36 16-bit indices
+    return mesh{build_mesh(cube_vertices, 36, 6), std::move(format)};
+}
@@ -0,0 +1,14 @@
+#include "mesh.hpp"
+#include "mesh_builder.hpp"
+
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+// unit cube as a triangle soup, interleaved position and normal, indexed by make_cube_mesh
+extern const float cube_vertices[216];
+
+// to build the shared unit cube mesh (position at location 0, normal at location 1).
+// packed stores half float positions and 2_10_10_10 normals, 12 bytes per vertex instead of 24
+mesh make_cube_mesh(bool packed = true);
+
+#endif //PRIMITIVES_H
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "profiler.hpp"
+
+void profile_buffer::collect(std::uint64_t since, std::vector<profile_event> &out) const
+{
+    std::size_t end{head.load(std::memory_order_acquire)};
+    std::size_t begin{end > PROFILE_BUFFER_EVENTS ? end - PROFILE_BUFFER_EVENTS : 0};
+
+    for (std::size_t i = begin; i < end; i++)
+    {
+        const profile_event &event{events[i % PROFILE_BUFFER_EVENTS]};
+        if (event.start >= since)
+            out.push_back(event);
+    }
+}
+
+profiler &profiler::get()
+{
+    static profiler instance{};
+    return instance;
+}
+
+profiler::profiler()
+    : epoch(std::chrono::steady_clock::now())
+{
+}
+
+std::uint64_t profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+profile_buffer &profiler::local_buffer()
+{
+    thread_local profile_buffer *buffer{nullptr};
+
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock{buffers_mutex};
+        buffers.push_back(std::make_unique<profile_buffer>((std::uint32_t)buffers.size() + 1));
+        buffer = buffers.back().get();
+    }
+
+    return *buffer;
+}
+
+void profiler::record_scope(const char *name, std::uint64_t start, std::uint64_t end)
+{
+    local_buffer().push(profile_event{name, start, end - start, 0.0, nullptr, 'X'});
+}
+
+void profiler::record_counter(const char *name, double value)
+{
+    local_buffer().push(profile_event{name, now(), 0, value, nullptr, 'C'});
+}
+
+void profiler::record_gpu_scope(const char *name, std::uint64_t start, std::uint64_t end)
+{
+    gpu_buffer.push(profile_event{name, start, end - start, 0.0, nullptr, 'X'});
+}
+
+void profiler::record_gpu_counter(const char *name, const char *series, std::uint64_t time, double value)
+{
+    gpu_buffer.push(profile_event{name, time, 0, value, series, 'C'});
+}
+
+void profiler::end_frame()
+{
+    // frames are ended on the main thread only
+    frame_count++;
+    frame_starts[frame_count % frame_starts.size()] = now();
+}
+
+void profiler::current_frame_scopes(std::vector<profile_event> &out)
+{
+    std::size_t first{out.size()};
+    local_buffer().collect(frame_starts[frame_count % frame_starts.size()], out);
+
+    out.erase(std::remove_if(out.begin() + first, out.end(), [](const profile_event &event) {return event.phase != 'X';}), out.end());
+}
+
+bool profiler::write_chrome_trace(const std::string &path)
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cout << "ERROR::PROFILER::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+
+    // the start of the oldest frame still retained, zero until PROFILE_FRAMES frames have passed
+    std::uint64_t since{0};
+    if (frame_count >= PROFILE_FRAMES)
+        since = frame_starts[(frame_count - PROFILE_FRAMES) % frame_starts.size()];
+
+    std::lock_guard<std::mutex> lock{buffers_mutex};
+
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool first{true};
+    std::vector<profile_event> events{};
+
+    std::vector<const profile_buffer *> all_buffers{&gpu_buffer};
+    for (const std::unique_ptr<profile_buffer> &buffer : buffers)
+        all_buffers.push_back(buffer.get());
+
+    for (const profile_buffer *buffer : all_buffers)
+    {
+        events.clear();
+        buffer->collect(since, events);
+
+        for (const profile_event &event : events)
+        {
+            file << (first ? "" : ",\n");
+            first = false;
+
+            // chrome trace times are in microseconds
+            file << "{\"name\": \"" << event.name << "\", \"ph\": \"" << event.phase << "\", \"pid\": 1, \"tid\": "
+                 << buffer->get_thread_id() << ", \"ts\": " << event.start / 1000.0;
+
+            if (event.phase == 'X')
+                file << ", \"dur\": " << event.duration / 1000.0 << "}";
+            else
+                file << ", \"args\": {\"" << (event.series ? event.series : "value") << "\": " << event.value << "}}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    std::cout << "wrote profile to " << path << std::endl;
+
+    return true;
+}
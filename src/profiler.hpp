@@ -0,0 +1,156 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// number of most recent frames a trace dump covers
+#define PROFILE_FRAMES 120
+
+// events each thread keeps before the oldest are overwritten, enough for PROFILE_FRAMES busy frames
+#define PROFILE_BUFFER_EVENTS (1 << 16)
+
+// a finished scope or a counter sample. names must be string literals, they are stored as pointers
+struct profile_event
+{
+    const char *name{};
+
+    // nanoseconds since the profiler started
+    std::uint64_t start{};
+
+    // scopes only
+    std::uint64_t duration{};
+
+    // counters only, series names the graph's line and defaults to "value"
+    double value{};
+    const char *series{};
+
+    // chrome trace phase, 'X' for a scope and 'C' for a counter
+    char phase{};
+};
+
+// events recorded by a single thread. only the owning thread writes, so pushing takes no lock
+class profile_buffer
+{
+public:
+    explicit profile_buffer(std::uint32_t a_thread_id) : thread_id(a_thread_id) {};
+
+    void push(const profile_event &event)
+    {
+        std::size_t index{head.load(std::memory_order_relaxed)};
+        events[index % PROFILE_BUFFER_EVENTS] = event;
+
+        // publishes the event to a dump running on another thread
+        head.store(index + 1, std::memory_order_release);
+    };
+
+    // to copy out every retained event that started at or after a time
+    void collect(std::uint64_t since, std::vector<profile_event> &out) const;
+
+    std::uint32_t get_thread_id() const {return thread_id;};
+
+private:
+    std::array<profile_event, PROFILE_BUFFER_EVENTS> events{};
+
+    // total events pushed, the buffer holds the last PROFILE_BUFFER_EVENTS of them
+    std::atomic<std::size_t> head{0};
+
+    std::uint32_t thread_id{};
+};
+
+// collects scopes and counters from every thread and writes the last PROFILE_FRAMES frames
+// as chrome trace json (chrome://tracing, ui.perfetto.dev). use it through the PROFILE_ macros,
+// which compile to nothing unless OXIDIZER_PROFILE is defined
+class profiler
+{
+public:
+    static profiler &get();
+
+    // nanoseconds since the profiler started
+    std::uint64_t now() const;
+
+    void record_scope(const char *name, std::uint64_t start, std::uint64_t end);
+    void record_counter(const char *name, double value);
+
+    // to record gpu work on its own track, times already converted to the profiler's clock.
+    // only the thread that owns the GL context may call these
+    void record_gpu_scope(const char *name, std::uint64_t start, std::uint64_t end);
+    void record_gpu_counter(const char *name, const char *series, std::uint64_t time, double value);
+
+    // to mark the end of a frame, dumps cover whole frames
+    void end_frame();
+
+    // to copy out the calling thread's scopes since the last end_frame, the frame in progress
+    void current_frame_scopes(std::vector<profile_event> &out);
+
+    // to write the retained frames of every thread, returns false if the file can't be written
+    bool write_chrome_trace(const std::string &path);
+
+private:
+    profiler();
+
+    // the calling thread's buffer, registered on its first event
+    profile_buffer &local_buffer();
+
+    std::chrono::steady_clock::time_point epoch{};
+
+    // guards registration and dumps, never taken while recording
+    std::mutex buffers_mutex{};
+
+    // buffers outlive their threads, so a dump still sees events from finished workers.
+    // each recording thread costs one buffer, so record from long-lived threads only
+    std::vector<std::unique_ptr<profile_buffer>> buffers{};
+
+    // gpu scopes and counters, shown as thread 0
+    profile_buffer gpu_buffer{0};
+
+    // start times of the last PROFILE_FRAMES frames and the one in progress
+    std::array<std::uint64_t, PROFILE_FRAMES + 1> frame_starts{};
+    std::uint64_t frame_count{0};
+};
+
+// records the time between its construction and destruction
+class profile_scope
+{
+public:
+    explicit profile_scope(const char *a_name) : name(a_name), start(profiler::get().now()) {};
+    ~profile_scope() {profiler::get().record_scope(name, start, profiler::get().now());};
+
+    profile_scope(const profile_scope &) = delete;
+    profile_scope &operator=(const profile_scope &) = delete;
+
+private:
+    const char *name;
+    std::uint64_t start;
+};
+
+#ifdef OXIDIZER_PROFILE
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// to time the rest of the enclosing scope
+#define PROFILE_SCOPE(name) profile_scope PROFILE_CONCAT(profile_scope_, __LINE__){name}
+
+// to sample a named counter, shown as a graph in the trace
+#define PROFILE_COUNTER(name, value) profiler::get().record_counter(name, (double)(value))
+
+#define PROFILE_FRAME() profiler::get().end_frame()
+#define PROFILE_DUMP(path) profiler::get().write_chrome_trace(path)
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_DUMP(path) ((void)0)
+
+#endif //OXIDIZER_PROFILE
+
+#endif //PROFILER_H
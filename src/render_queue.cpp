@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cassert>
+
+#include "render_queue.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+
+// key layout, most significant first:
+// opaque:      pass (2) | program (8) | material (12) | mesh (16) | depth (24) | unused (2)
+// transparent: pass (2) | inverted depth (24) | program (8) | material (12) | mesh (16) | unused (2)
+#define KEY_PASS_SHIFT 62
+#define KEY_DEPTH_BITS 24
+#define KEY_DEPTH_MAX ((1u << KEY_DEPTH_BITS) - 1)
+
+void render_queue::begin(const glm::mat4 &a_view, float a_near, float a_far)
+{
+    view = a_view;
+    near_plane = a_near;
+    far_plane = a_far;
+
+    // keeps the capacity, so a steady frame doesn't reallocate
+    packets.clear();
+}
+
+void render_queue::submit(const render_packet &packet)
+{
+    packets.push_back(packet);
+}
+
+float render_queue::depth_of(const glm::vec3 &world_pos) const
+{
+    // the camera looks down -z in view space
+    float view_z{-(view * glm::vec4(world_pos, 1.0f)).z};
+
+    return glm::clamp((view_z - near_plane) / (far_plane - near_plane), 0.0f, 1.0f);
+}
+
+std::uint64_t render_queue::make_key(render_pass pass, const shader &program, std::uint16_t material, unsigned int vertex_array, float depth) const
+{
+    std::uint64_t quantized_depth{(std::uint64_t)(glm::clamp(depth, 0.0f, 1.0f) * KEY_DEPTH_MAX)};
+
+    // vertex array names go in whole, they stay small in practice but nothing guarantees it
+    assert(vertex_array <= 0xFFFF && "vertex array name doesn't fit the render queue's mesh field");
+
+    std::uint64_t state{((std::uint64_t)program.get_sort_id() << 28) |
+                        ((std::uint64_t)(material & 0xFFF) << 16) |
+                        (std::uint64_t)(vertex_array & 0xFFFF)};
+
+    std::uint64_t key{(std::uint64_t)pass << KEY_PASS_SHIFT};
+
+    if (pass == render_pass::transparent)
+    {
+        // back-to-front, blending needs the far objects first
+        key |= (KEY_DEPTH_MAX - quantized_depth) << 38;
+        key |= state << 2;
+    }
+    else
+    {
+        // group by state to avoid binds, then front-to-back for early depth rejection
+        key |= state << 26;
+        key |= quantized_depth << 2;
+    }
+
+    return key;
+}
+
+void render_queue::radix_sort()
+{
+    std::size_t count{packets.size()};
+
+    // transient, these are freed with the rest of the frame
+    order = arena.allocate<std::uint32_t>(count);
+    frame_span<std::uint32_t> scratch{arena.allocate<std::uint32_t>(count)};
+    frame_span<std::uint64_t> keys{arena.allocate<std::uint64_t>(count)};
+    frame_span<std::uint64_t> scratch_keys{arena.allocate<std::uint64_t>(count)};
+
+    for (std::size_t i{}; i < count; i++)
+    {
+        order[i] = (std::uint32_t)i;
+        keys[i] = packets[i].key;
+    }
+
+    for (int shift{}; shift < 64; shift += 8)
+    {
+        std::size_t histogram[256]{};
+
+        for (std::size_t i{}; i < count; i++)
+            histogram[(keys[i] >> shift) & 0xFF]++;
+
+        // every key has the same byte here, this pass wouldn't move anything
+        if (histogram[(keys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        std::size_t offset{};
+
+        for (std::size_t &bucket : histogram)
+        {
+            std::size_t bucket_count{bucket};
+            bucket = offset;
+            offset += bucket_count;
+        }
+
+        for (std::size_t i{}; i < count; i++)
+        {
+            std::size_t destination{histogram[(keys[i] >> shift) & 0xFF]++};
+
+            scratch[destination] = order[i];
+            scratch_keys[destination] = keys[i];
+        }
+
+        std::swap(order, scratch);
+        std::swap(keys, scratch_keys);
+    }
+}
+
+void render_queue::flush([[maybe_unused]] gpu_profiler *draw_profiler)
+{
+    if (packets.empty())
+        return;
+
+    PROFILE_SCOPE("render_queue::flush");
+    ALLOC_SCOPE("render_queue");
+
+    {
+        PROFILE_SCOPE("render_queue::sort");
+        radix_sort();
+    }
+
+    for (std::uint32_t index : order)
+    {
+        render_packet &packet{packets[index]};
+
+        // sorted packets share programs and vertex arrays with their neighbours, gl_state drops the repeated binds
+        packet.program->use();
+        gl_state::get().bind_vertex_array(packet.VAO);
+
+        if (packet.prepare)
+            packet.prepare(packet.object);
+
+        GPU_PROFILE_SCOPE(draw_profiler, "draw");
+
+        // the gpu drops the draw if the query drew no samples, and draws it if the result isn't in yet
+        if (packet.condition)
+            glBeginConditionalRender(packet.condition, GL_QUERY_NO_WAIT);
+
+        if (packet.index_type && packet.instance_count == 1)
+            glDrawElements(GL_TRIANGLES, packet.vertex_count, packet.index_type, nullptr);
+        else if (packet.index_type)
+            glDrawElementsInstanced(GL_TRIANGLES, packet.vertex_count, packet.index_type, nullptr, packet.instance_count);
+        else if (packet.instance_count == 1)
+            glDrawArrays(GL_TRIANGLES, 0, packet.vertex_count);
+        else
+            glDrawArraysInstanced(GL_TRIANGLES, 0, packet.vertex_count, packet.instance_count);
+
+        if (packet.condition)
+            glEndConditionalRender();
+
+        g_render_stats.draw_calls++;
+    }
+}
@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.hpp"
+#include "gpu_profiler.hpp"
+#include "frame_arena.hpp"
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// passes are drawn in this order
+enum class render_pass : std::uint8_t
+{
+    opaque = 0,
+    transparent = 1,
+    overlay = 2
+};
+
+// a single draw submitted to the queue
+struct render_packet
+{
+    // packed pass, program, material, mesh and depth, see render_queue::make_key
+    std::uint64_t key{};
+
+    shader *program{};
+    unsigned int VAO{};
+
+    // number of indices drawn, or vertices for a non-indexed draw
+    GLsizei vertex_count{};
+
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT for an indexed draw, 0 for a non-indexed one
+    GLenum index_type{};
+
+    // 1 for a plain draw, more for an instanced draw
+    GLsizei instance_count{1};
+
+    // to set per-draw uniforms or stream instance data right before drawing, may be null
+    void (*prepare)(void *object){};
+    void *object{};
+
+    // an occlusion query the draw is conditioned on, 0 to always draw
+    unsigned int condition{};
+};
+
+class render_queue
+{
+public:
+    // sort buffers come from the arena's current frame
+    explicit render_queue(frame_arena &a_arena) : arena(a_arena) {};
+
+    // to start a new frame, the view matrix and depth range are used to build depth keys
+    void begin(const glm::mat4 &a_view, float a_near, float a_far);
+
+    // to add a packet, its key must already be built with make_key
+    void submit(const render_packet &packet);
+
+    // to sort the packets and draw them, binding programs and vertex arrays only when they change.
+    // with a gpu profiler, every draw is timed as its own scope
+    void flush(gpu_profiler *draw_profiler = nullptr);
+
+    // to pack a sort key, opaque packets sort by state then front-to-back, transparent ones back-to-front first.
+    // the mesh field is the vertex array the packet draws with, since that is what gets bound
+    std::uint64_t make_key(render_pass pass, const shader &program, std::uint16_t material, unsigned int vertex_array, float depth) const;
+
+    // to get the normalized view depth of a world position, 0 at the near plane
+    float depth_of(const glm::vec3 &world_pos) const;
+
+    std::size_t size() const {return packets.size();};
+
+private:
+    // to sort order by key, least significant byte first, skipping bytes every key shares
+    void radix_sort();
+
+    glm::mat4 view{1.0f};
+    float near_plane{};
+    float far_plane{1.0f};
+
+    frame_arena &arena;
+
+    // keeps its capacity between frames, so submitting never reallocates in a steady frame
+    std::vector<render_packet> packets;
+
+    // packet indices in draw order, in the arena until the frame is flushed
+    frame_span<std::uint32_t> order{};
+};
+
+#endif //RENDER_QUEUE_H
@@ -0,0 +1,75 @@
+#include <cstdint>
+
+#include "profiler.hpp"
+
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// counters gathered over a single frame, reset at the start of every frame
+struct render_stats
+{
+    // bytes sent through glUniform* and uniform buffer uploads
+    std::uint64_t uniform_bytes{};
+
+    // glUniform* calls skipped because the program already held the value
+    std::uint64_t uniform_calls_skipped{};
+
+    // number of glDraw* calls issued
+    std::uint64_t draw_calls{};
+
+    // program and vertex array binds that reached the driver
+    std::uint64_t program_binds{};
+    std::uint64_t vao_binds{};
+
+    // state calls gl_state passed to the driver and the redundant ones it dropped
+    std::uint64_t state_calls_issued{};
+    std::uint64_t state_calls_skipped{};
+
+    // cube instances frustum culling kept out of the instance buffer
+    std::uint64_t instances_culled{};
+
+    // cube instances the software occlusion buffer found hidden
+    std::uint64_t instances_occluded{};
+
+    // cube records copied into the instance buffer, only when the visible set changes
+    std::uint64_t instances_copied{};
+
+    // meshes whose geometry was uploaded, only while a scene loads
+    std::uint64_t meshes_uploaded{};
+
+    // hardware occlusion queries issued on proxy boxes
+    std::uint64_t occlusion_queries{};
+
+    // object draws skipped on the cpu because their last query drew no samples
+    std::uint64_t draws_skipped{};
+
+    // query results read back with no samples. in conditional mode the gpu skips the draw only if the
+    // result was ready in time, which the cpu can't see, so this is an upper bound on what it dropped
+    std::uint64_t occluded_results{};
+
+    // 1 when the cached static layer had to be drawn again this frame
+    std::uint64_t static_layer_renders{};
+
+    void reset(){*this = render_stats{};};
+};
+
+// the stats for the frame currently being rendered
+inline render_stats g_render_stats{};
+
+// to graph the current frame's stats as profiler counters
+inline void profile_render_stats()
+{
+    PROFILE_COUNTER("draw_calls", g_render_stats.draw_calls);
+    PROFILE_COUNTER("state_calls_issued", g_render_stats.state_calls_issued);
+    PROFILE_COUNTER("state_calls_skipped", g_render_stats.state_calls_skipped);
+    PROFILE_COUNTER("uniform_bytes", g_render_stats.uniform_bytes);
+    PROFILE_COUNTER("instances_culled", g_render_stats.instances_culled);
+    PROFILE_COUNTER("instances_occluded", g_render_stats.instances_occluded);
+    PROFILE_COUNTER("instances_copied", g_render_stats.instances_copied);
+    PROFILE_COUNTER("occlusion_queries", g_render_stats.occlusion_queries);
+    PROFILE_COUNTER("draws_skipped", g_render_stats.draws_skipped);
+    PROFILE_COUNTER("occluded_results", g_render_stats.occluded_results);
+    PROFILE_COUNTER("static_layer_renders", g_render_stats.static_layer_renders);
+}
+
+#endif //RENDER_STATS_H
@@ -0,0 +1,29 @@
+#include <iostream>
+
+#include "render_target.hpp"
+#include "gl_state.hpp"
+
+render_target::render_target(int a_width, int a_height)
+    : FBO(framebuffer::create()), color(texture::create()), depth(renderbuffer::create()), width(a_width), height(a_height)
+{
+    gl_state::get().bind_framebuffer(GL_FRAMEBUFFER, FBO.get());
+
+    gl_state::get().bind_texture(GL_TEXTURE_2D, color.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color.get(), 0);
+
+    gl_state::get().bind_renderbuffer(depth.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth.get());
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
+    gl_state::get().bind_framebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void render_target::bind() const
+{
+    gl_state::get().viewport(0, 0, width, height);
+    gl_state::get().bind_framebuffer(GL_FRAMEBUFFER, FBO.get());
+}
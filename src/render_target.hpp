@@ -0,0 +1,31 @@
+#include <glad/glad.h>
+
+#include "gl_handle.hpp"
+
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+// an offscreen framebuffer with a color texture and a depth-stencil renderbuffer
+class render_target
+{
+public:
+    render_target(int a_width, int a_height);
+
+    // to bind the framebuffer for drawing and reading, and set the viewport to its size
+    void bind() const;
+
+    unsigned int get_fbo() const {return FBO.get();};
+    unsigned int get_color() const {return color.get();};
+
+    int get_width() const {return width;};
+    int get_height() const {return height;};
+
+private:
+    framebuffer FBO{};
+    texture color{};
+    renderbuffer depth{};
+
+    int width{}, height{};
+};
+
+#endif //RENDER_TARGET_H
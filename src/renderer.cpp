@@ -0,0 +1,246 @@
+#include "renderer.hpp"
+#include "gl_state.hpp"
+#include "primitives.hpp"
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+
+//shader paths
+const char *LIGHT_VERTEX_SHADER_PATH = "shaders/light_vert.glsl";
+const char *LIGHT_FRAGMENT_SHADER_PATH = "shaders/light_frag.glsl";
+
+const char *CUBE_FRAGMENT_SHADER_PATH = "shaders/cube_frag.glsl";
+
+const char *CUBE_INSTANCED_VERTEX_SHADER_PATH = "shaders/cube_instanced_vert.glsl";
+
+const char *MESH_VERTEX_SHADER_PATH = "shaders/mesh_vert.glsl";
+const char *MESH_INVERSE_VERTEX_SHADER_PATH = "shaders/mesh_inverse_vert.glsl";
+
+renderer::renderer(int r_width, int r_height, bool packed_layouts)
+    : render_width(r_width), render_height(r_height),
+      l_program(LIGHT_VERTEX_SHADER_PATH, LIGHT_FRAGMENT_SHADER_PATH),
+      c_program(CUBE_INSTANCED_VERTEX_SHADER_PATH, CUBE_FRAGMENT_SHADER_PATH),
+      m_program(MESH_VERTEX_SHADER_PATH, CUBE_FRAGMENT_SHADER_PATH),
+      m_inverse_program(MESH_INVERSE_VERTEX_SHADER_PATH, CUBE_FRAGMENT_SHADER_PATH),
+      cube_mesh(meshes.add("cube", make_cube_mesh(packed_layouts))),
+      cubes(c_program, meshes.get(cube_mesh), packed_layouts),
+      a_camera(r_width, r_height),
+      target(r_width, r_height),
+      static_layer(r_width, r_height),
+      occlusion(r_width, r_height),
+      queries(l_program, meshes.get(cube_mesh))
+{
+    gl_state::get().enable(GL_DEPTH_TEST);
+}
+
+light &renderer::add_light(glm::vec3 a_pos, glm::vec3 a_color)
+{
+    return lights.emplace_back(l_program, meshes.get(cube_mesh), a_pos, a_color);
+}
+
+mesh_object &renderer::add_object(const glm::mat4 &a_model, glm::vec3 a_color)
+{
+    return objects.emplace_back(vertex_normal_matrix ? m_inverse_program : m_program, meshes.get(cube_mesh), a_model, a_color);
+}
+
+void renderer::clear_scene()
+{
+    cubes.clear();
+    queries.reset();
+    lights.clear();
+    objects.clear();
+}
+
+void renderer::update_frame_uniforms()
+{
+    per_frame.set_camera(a_camera);
+    per_frame.clear_lights();
+
+    for (light &a_light : lights)
+        per_frame.add_light(a_light.get_pos(), a_light.get_color());
+}
+
+std::uint64_t renderer::objects_version() const
+{
+    std::uint64_t version{0};
+    for (const mesh_object &object : objects)
+        version += object.get_version();
+
+    return version;
+}
+
+bool renderer::needs_render()
+{
+    update_frame_uniforms();
+
+    return force_render || per_frame.changed() ||
+           cubes.get_version() != rendered_cubes ||
+           objects.size() != rendered_object_count || objects_version() != rendered_objects ||
+           lights.size() != rendered_lights ||
+           (queries.get_mode() == occlusion_query_mode::latent && queries.poll());
+}
+
+void renderer::render_static_layer()
+{
+    PROFILE_SCOPE("renderer::render_static_layer");
+    GPU_PROFILE_SCOPE(&gpu, "static_layer");
+
+    g_render_stats.static_layer_renders++;
+
+    static_layer.bind();
+
+    gl_state::get().enable(GL_DEPTH_TEST);
+
+    gl_state::get().clear_color(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glm::mat4 view_projection{a_camera.get_proj() * a_camera.get_view()};
+
+    if (occlusion_culling)
+        occlusion.begin(view_projection);
+
+    cubes.cull(frustum::from_matrix(view_projection), occlusion_culling ? &occlusion : nullptr);
+
+    queue.begin(a_camera.get_view(), -100.0f, 100.0f);
+    cubes.submit(queue);
+    queue.flush(gpu.get_per_draw() ? &gpu : nullptr);
+
+    static_cubes = cubes.get_version();
+    static_stale = false;
+}
+
+void renderer::composite_static_layer()
+{
+    PROFILE_SCOPE("renderer::composite_static_layer");
+    GPU_PROFILE_SCOPE(&gpu, "composite");
+
+    // depth blits need matching formats and nearest filtering, both targets are built the same way
+    gl_state::get().bind_framebuffer(GL_READ_FRAMEBUFFER, static_layer.get_fbo());
+    gl_state::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, target.get_fbo());
+    glBlitFramebuffer
+    (
+        0, 0, render_width, render_height,
+        0, 0, render_width, render_height,
+        GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST
+    );
+}
+
+void renderer::render()
+{
+    PROFILE_SCOPE("renderer::render");
+    ALLOC_SCOPE("renderer");
+
+    arena.begin_frame();
+
+    GPU_PROFILE_FRAME(&gpu);
+    GPU_PROFILE_SCOPE(&gpu, "scene");
+
+    // the cubes are lit, so a moved camera or light invalidates the static layer too
+    update_frame_uniforms();
+    if (per_frame.changed() || cubes.get_version() != static_cubes || force_render)
+        static_stale = true;
+
+    per_frame.upload();
+
+    rendered_cubes = cubes.get_version();
+    rendered_objects = objects_version();
+    rendered_object_count = objects.size();
+    rendered_lights = lights.size();
+    force_render = false;
+
+    if (static_stale)
+        render_static_layer();
+
+    // start from the cached cubes, dynamic draws are depth tested against them
+    composite_static_layer();
+
+    target.bind();
+
+    gl_state::get().enable(GL_DEPTH_TEST);
+
+    // draw every object and light gizmo over the static layer
+    queue.begin(a_camera.get_view(), -100.0f, 100.0f);
+    submit_dynamic();
+    queue.flush(gpu.get_per_draw() ? &gpu : nullptr);
+}
+
+void renderer::submit_dynamic()
+{
+    if (queries.get_mode() == occlusion_query_mode::off)
+    {
+        for (mesh_object &object : objects)
+            object.submit(queue);
+
+        for (light &a_light : lights)
+            a_light.submit(queue);
+
+        return;
+    }
+
+    PROFILE_SCOPE("renderer::occlusion_queries");
+    GPU_PROFILE_SCOPE(&gpu, "occlusion_queries");
+
+    // proxies only see the cubes, objects never hide each other
+    queries.begin(objects.size() + lights.size(), a_camera.get_proj() * a_camera.get_view());
+
+    std::size_t index{0};
+
+    for (mesh_object &object : objects)
+    {
+        if (queries.test(index, object.get_bounds()))
+            object.submit(queue, queries.condition(index));
+
+        index++;
+    }
+
+    for (light &a_light : lights)
+    {
+        if (queries.test(index, a_light.get_bounds()))
+            a_light.submit(queue, queries.condition(index));
+
+        index++;
+    }
+
+    queries.end();
+}
+
+void renderer::present(int screen_width, int screen_height)
+{
+    PROFILE_SCOPE("renderer::present");
+    GPU_PROFILE_SCOPE(&gpu, "blit");
+
+    gl_state::get().bind_framebuffer(GL_READ_FRAMEBUFFER, target.get_fbo());
+    gl_state::get().bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer
+    (
+        0, 0, render_width, render_height,
+        0, 0, screen_width, screen_height,
+        GL_COLOR_BUFFER_BIT, GL_NEAREST
+    );
+}
+
+int renderer::pick(double x, double y, int screen_width, int screen_height) const
+{
+    // window rows grow downwards, the viewport's upwards
+    glm::vec4 viewport{0.0f, 0.0f, (float)screen_width, (float)screen_height};
+    glm::vec3 window_pos{(float)x, (float)(screen_height - y), 0.0f};
+
+    glm::vec3 near_point{glm::unProject(window_pos, a_camera.get_view(), a_camera.get_proj(), viewport)};
+    window_pos.z = 1.0f;
+    glm::vec3 far_point{glm::unProject(window_pos, a_camera.get_view(), a_camera.get_proj(), viewport)};
+
+    float t{};
+    return cubes.raycast(near_point, glm::normalize(far_point - near_point), t);
+}
+
+void renderer::read_pixels(std::vector<std::uint8_t> &rgb) const
+{
+    PROFILE_SCOPE("renderer::read_pixels");
+
+    rgb.resize((std::size_t)render_width * render_height * 3);
+
+    gl_state::get().bind_framebuffer(GL_READ_FRAMEBUFFER, target.get_fbo());
+
+    // rows of 320 RGB pixels aren't 4 byte multiples in general
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, render_width, render_height, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+}
@@ -0,0 +1,157 @@
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "camera.hpp"
+#include "cube_batch.hpp"
+#include "frame_uniforms.hpp"
+#include "frame_arena.hpp"
+#include "gpu_profiler.hpp"
+#include "light.hpp"
+#include "mesh.hpp"
+#include "mesh_object.hpp"
+#include "occlusion_buffer.hpp"
+#include "occlusion_queries.hpp"
+#include "render_queue.hpp"
+#include "render_target.hpp"
+#include "shader.hpp"
+
+#ifndef RENDERER_H
+#define RENDERER_H
+
+// owns the programs, meshes, scene objects and the low resolution render target,
+// and draws a frame into it. windowed, headless and benchmark runs all share it.
+// the cube batch is the static layer, cached with its depth and drawn again only when the cubes,
+// camera or lights change. mesh objects and light gizmos are dynamic and drawn over it every frame
+class renderer
+{
+public:
+    // packed layouts store the cube mesh and cube instances in the compact vertex formats,
+    // otherwise every attribute is a full float, to check the packed formats against
+    renderer(int r_width, int r_height, bool packed_layouts = true);
+
+    renderer(const renderer &) = delete;
+    renderer &operator=(const renderer &) = delete;
+
+    // to draw the scene into the render target, the static layer only if it went stale
+    void render();
+
+    // whether the camera, a light, a cube or an object changed since the last render
+    bool needs_render();
+
+    // to render again next time whatever changed, for changes needs_render can't see
+    void mark_dirty() {force_render = true;};
+
+    // to upscale the render target onto the default framebuffer
+    void present(int screen_width, int screen_height);
+
+    // to test cubes against occluders rasterized on the cpu before drawing them
+    void set_occlusion_culling(bool enabled) {occlusion_culling = enabled;};
+    bool get_occlusion_culling() const {return occlusion_culling;};
+
+    // to test mesh objects and light gizmos with hardware occlusion queries against the cubes before drawing them
+    void set_occlusion_queries(occlusion_query_mode mode) {queries.set_mode(mode);};
+    occlusion_query_mode get_occlusion_queries() const {return queries.get_mode();};
+
+    // to find the cube under a window position in screen coordinates, -1 if there's none
+    int pick(double x, double y, int screen_width, int screen_height) const;
+
+    // to read the render target back as tightly packed RGB rows, bottom row first
+    void read_pixels(std::vector<std::uint8_t> &rgb) const;
+
+    // to add a light, references stay valid as more are added
+    light &add_light(glm::vec3 a_pos, glm::vec3 a_color);
+
+    // to add an arbitrarily transformed lit cube, references stay valid as more are added
+    mesh_object &add_object(const glm::mat4 &a_model, glm::vec3 a_color);
+
+    // to give objects added from now on a vertex shader that inverts the model matrix per vertex
+    // instead of taking the normal matrix from the cpu, only to benchmark the two against each other
+    void set_vertex_normal_matrix(bool enabled) {vertex_normal_matrix = enabled;};
+    bool get_vertex_normal_matrix() const {return vertex_normal_matrix;};
+
+    // to remove every cube, light and object
+    void clear_scene();
+
+    camera &get_camera() {return a_camera;};
+    cube_batch &get_cubes() {return cubes;};
+    std::deque<light> &get_lights() {return lights;};
+    std::deque<mesh_object> &get_objects() {return objects;};
+    mesh_registry &get_meshes() {return meshes;};
+    mesh_id get_cube_mesh() const {return cube_mesh;};
+    const render_target &get_target() const {return target;};
+    gpu_profiler &get_gpu_profiler() {return gpu;};
+    const frame_arena &get_arena() const {return arena;};
+
+private:
+    // to fill the per-frame uniform block from the camera and lights
+    void update_frame_uniforms();
+
+    // the sum of every object's version
+    std::uint64_t objects_version() const;
+
+    // to draw the cube batch into the static layer
+    void render_static_layer();
+
+    // to copy the static layer's color and depth into the render target
+    void composite_static_layer();
+
+    // to queue every object and light gizmo, through their occlusion queries when they're on
+    void submit_dynamic();
+
+    int render_width, render_height;
+
+    shader l_program;
+    shader c_program;
+    shader m_program;
+    shader m_inverse_program;
+
+    // geometry is uploaded once here and shared by every object that draws it
+    mesh_registry meshes{};
+    mesh_id cube_mesh{};
+
+    cube_batch cubes;
+    std::deque<light> lights{};
+    std::deque<mesh_object> objects{};
+
+    camera a_camera;
+
+    // camera and lights, uploaded once per frame and shared by every program
+    frame_uniforms per_frame{};
+
+    // transient per-frame data, reset in O(1) as frames go round
+    frame_arena arena{};
+
+    // every draw goes through the queue, sorted to minimize program and vertex array binds
+    render_queue queue{arena};
+
+    // times the scene pass and the blit, and optionally every draw, when profiling
+    gpu_profiler gpu{};
+
+    render_target target;
+
+    // the cubes as of the last static render, same size and formats as target so depth can be blitted
+    render_target static_layer;
+    std::uint64_t static_cubes{0};
+    bool static_stale{true};
+
+    // occluder depth at the render resolution, at half of it the unfilled pixels between occluders hid too little
+    occlusion_buffer occlusion;
+    bool occlusion_culling{true};
+
+    bool vertex_normal_matrix{false};
+
+    // proxy boxes for objects and gizmos, tested against the composited cubes' depth
+    occlusion_queries queries;
+
+    // what the last render drew, camera and the first MAX_LIGHTS lights are compared through the uniform block
+    std::uint64_t rendered_cubes{0};
+    std::uint64_t rendered_objects{0};
+    std::size_t rendered_lights{0};
+    std::size_t rendered_object_count{0};
+    bool force_render{true};
+};
+
+#endif //RENDERER_H
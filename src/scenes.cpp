@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "scenes.hpp"
+#include "cube.hpp"
+
+const char *scene_name(scene_kind kind)
+{
+    switch (kind)
+    {
+    case scene_kind::scatter: return "scatter";
+    case scene_kind::grid: return "grid";
+    case scene_kind::terrain: return "terrain";
+    case scene_kind::moving: return "moving";
+    }
+
+    return "unknown";
+}
+
+bool parse_scene(std::string_view name, scene_kind &kind)
+{
+    for (scene_kind candidate : {scene_kind::scatter, scene_kind::grid, scene_kind::terrain, scene_kind::moving})
+    {
+        if (name == scene_name(candidate))
+        {
+            kind = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// to add a cube at a world position, cube positions are in units of its scale
+static void add_cube(renderer &a_renderer, const glm::vec3 &world_pos, float scale, const glm::vec3 &color)
+{
+    a_renderer.get_cubes().add(cube{world_pos / scale, scale, color, a_renderer.get_cube_mesh()});
+}
+
+static void build_scatter(renderer &a_renderer, const scene_desc &desc, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> position{-SCENE_EXTENT, SCENE_EXTENT};
+    std::uniform_real_distribution<float> channel{0.2f, 1.0f};
+
+    // about half the volume filled, whatever the count
+    float scale{std::max(1.0f, SCENE_EXTENT / std::cbrt((float)desc.objects))};
+
+    for (int i = 0; i < desc.objects; i++)
+    {
+        glm::vec3 world_pos{position(rng), position(rng), position(rng)};
+        add_cube(a_renderer, world_pos, scale, glm::vec3(channel(rng), channel(rng), channel(rng)));
+    }
+}
+
+static void build_grid(renderer &a_renderer, const scene_desc &desc)
+{
+    int side{(int)std::ceil(std::cbrt((float)desc.objects))};
+    float spacing{2.0f * SCENE_EXTENT / side};
+
+    for (int i = 0; i < desc.objects; i++)
+    {
+        glm::ivec3 cell{i % side, (i / side) % side, i / (side * side)};
+        glm::vec3 world_pos{-SCENE_EXTENT + (glm::vec3(cell) + 0.5f) * spacing};
+
+        add_cube(a_renderer, world_pos, spacing * 0.8f, glm::vec3(cell) / (float)side);
+    }
+}
+
+static void build_terrain(renderer &a_renderer, const scene_desc &desc)
+{
+    int side{(int)std::ceil(std::sqrt((float)desc.objects))};
+    float spacing{2.0f * SCENE_EXTENT / side};
+
+    for (int i = 0; i < desc.objects; i++)
+    {
+        float x{-SCENE_EXTENT + (i % side + 0.5f) * spacing};
+        float z{-SCENE_EXTENT + (i / side + 0.5f) * spacing};
+
+        // rolling hills, snapped to whole cubes so neighbouring columns line up
+        float height{0.25f * SCENE_EXTENT * (std::sin(x * 0.05f) + std::cos(z * 0.07f))};
+        height = std::round(height / spacing) * spacing;
+
+        // green valleys, white peaks
+        float t{glm::clamp(height / (0.5f * SCENE_EXTENT) * 0.5f + 0.5f, 0.0f, 1.0f)};
+
+        add_cube(a_renderer, glm::vec3(x, height, z), spacing, glm::mix(glm::vec3(0.2f, 0.6f, 0.2f), glm::vec3(1.0f), t));
+    }
+}
+
+// to transform a moving object at a frame, a spin around its own axis with a non-uniform scale
+static glm::mat4 moving_model(const glm::vec3 &world_pos, float size, int index, int frame)
+{
+    glm::vec3 axis{glm::normalize(glm::vec3(std::sin(index * 1.7f), 1.0f, std::cos(index * 0.9f)))};
+    float angle{glm::radians(2.0f * frame + index * 37.0f)};
+
+    glm::mat4 model{glm::translate(glm::mat4(1.0f), world_pos)};
+    model = glm::rotate(model, angle, axis);
+    return glm::scale(model, glm::vec3(size, size * 0.5f, size * 1.5f));
+}
+
+static void build_moving(renderer &a_renderer, const scene_desc &desc, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> position{-SCENE_EXTENT, SCENE_EXTENT};
+    std::uniform_real_distribution<float> channel{0.2f, 1.0f};
+
+    float size{std::max(1.0f, SCENE_EXTENT / std::cbrt((float)desc.objects))};
+
+    for (int i = 0; i < desc.objects; i++)
+    {
+        glm::vec3 world_pos{position(rng), position(rng), position(rng)};
+        glm::vec3 color{channel(rng), channel(rng), channel(rng)};
+
+        a_renderer.add_object(moving_model(world_pos, size, i, 0), color);
+    }
+}
+
+void build_scene(renderer &a_renderer, const scene_desc &desc)
+{
+    a_renderer.clear_scene();
+
+    std::mt19937 rng{desc.seed};
+
+    switch (desc.kind)
+    {
+    case scene_kind::scatter: build_scatter(a_renderer, desc, rng); break;
+    case scene_kind::grid: build_grid(a_renderer, desc); break;
+    case scene_kind::terrain: build_terrain(a_renderer, desc); break;
+    case scene_kind::moving: build_moving(a_renderer, desc, rng); break;
+    }
+
+    // lights on a ring above the scene, only the first MAX_LIGHTS shade but every gizmo draws
+    for (int i = 0; i < desc.lights; i++)
+    {
+        float angle{glm::two_pi<float>() * i / desc.lights};
+        glm::vec3 pos{std::cos(angle) * 0.75f, 0.5f, std::sin(angle) * 0.75f};
+        glm::vec3 color{0.5f + 0.5f * glm::cos(angle + glm::vec3(0.0f, 2.1f, 4.2f))};
+
+        // light positions are in units of the gizmo's scale of 16
+        a_renderer.add_light(pos * SCENE_EXTENT / 16.0f, color);
+    }
+}
+
+void animate_scene(renderer &a_renderer, const scene_desc &desc, int frame)
+{
+    if (desc.kind != scene_kind::moving)
+        return;
+
+    float size{std::max(1.0f, SCENE_EXTENT / std::cbrt((float)desc.objects))};
+
+    int index{0};
+    for (mesh_object &object : a_renderer.get_objects())
+    {
+        glm::vec3 world_pos{object.get_model()[3]};
+        object.set_model(moving_model(world_pos, size, index++, frame));
+    }
+}
@@ -0,0 +1,46 @@
+#include <string_view>
+
+#include "renderer.hpp"
+
+#ifndef SCENES_H
+#define SCENES_H
+
+// half the width of the region every generated scene fits in, inside the camera's depth range
+#define SCENE_EXTENT 80.0f
+
+enum class scene_kind
+{
+    // cubes at random positions and colors
+    scatter,
+
+    // a dense cube of cubes
+    grid,
+
+    // a heightfield of cubes, colored by height
+    terrain,
+
+    // rotating, non-uniformly scaled mesh objects, one draw each, with new transforms every frame
+    moving
+};
+
+// what to generate, the same description and seed always give the same scene
+struct scene_desc
+{
+    scene_kind kind{scene_kind::scatter};
+    int objects{1000};
+    int lights{1};
+    unsigned int seed{1};
+};
+
+const char *scene_name(scene_kind kind);
+
+// to look a scene kind up by name, returns false if there is none
+bool parse_scene(std::string_view name, scene_kind &kind);
+
+// to replace the renderer's scene with a generated one
+void build_scene(renderer &a_renderer, const scene_desc &desc);
+
+// to advance a generated scene to a frame, only moving scenes change
+void animate_scene(renderer &a_renderer, const scene_desc &desc, int frame);
+
+#endif //SCENES_H
@@ -1,7 +1,19 @@
+#include <cassert>
+
 #include "shader.hpp"
+#include "frame_uniforms.hpp"
+#include "gl_state.hpp"
+#include "render_stats.hpp"
+#include "profiler.hpp"
 
 shader::shader(const std::string &vert_path, const std::string &frag_path)
 {
+    PROFILE_SCOPE("shader::shader");
+
+    static std::uint32_t next_sort_id{0};
+    assert(next_sort_id < SHADER_SORT_IDS && "too many shaders for the render queue's program field");
+    sort_id = (std::uint8_t)next_sort_id++;
+
     // read vertex shader data from source path
     std::string vs_source{readfile(vert_path)};
 
@@ -33,53 +45,134 @@ shader::shader(const std::string &vert_path, const std::string &frag_path)
     glCompileShader(fs);
 
     // create shader program
-    program = glCreateProgram();
+    program = program_handle::create();
 
     // attach the vertex shader
-    glAttachShader(program, vs);
+    glAttachShader(program.get(), vs);
 
     // attach the fragment shader
-    glAttachShader(program, fs);
+    glAttachShader(program.get(), fs);
 
     // delete the vertex and fragment shader as they are now attached to the shader program
     glDeleteShader(vs);
     glDeleteShader(fs);
 
     // link the shader program
-    glLinkProgram(program);
+    glLinkProgram(program.get());
 
     // validate the shader program
-    glValidateProgram(program);
-}
+    glValidateProgram(program.get());
 
-shader::~shader()
-{
-    // delete the shader program on cleanup
-    glDeleteProgram(program);
+    // enumerate uniforms and blocks once, so setting them never queries the driver
+    reflect();
+
+    // attach the per-frame uniform block to its shared binding point, if this program declares it
+    bind_block("frame_data", FRAME_UNIFORM_BINDING);
 }
 
 void shader::use()
 {
     // use the shader program
-    glUseProgram(program);
+    gl_state::get().use_program(program.get());
 }
 
-void shader::set_mat4(const std::string &loc, const glm::mat4 &var) const
+void shader::set_mat4(std::string_view loc, const glm::mat4 &var)
 {
     // set a mat4 uniform
-    glUniformMatrix4fv(glGetUniformLocation(program, loc.c_str()), 1, GL_FALSE, &var[0][0]);
+    set(uniform<glm::mat4>{find_uniform(loc)}, var);
 }
 
-void shader::set_vec3(const std::string &loc, const glm::vec3 &var) const
+void shader::set_vec3(std::string_view loc, const glm::vec3 &var)
 {
     // set a vec3 uniform
-    glUniform3fv(glGetUniformLocation(program, loc.c_str()), 1, &var[0]);
+    set(uniform<glm::vec3>{find_uniform(loc)}, var);
 }
 
-void shader::set_int(const std::string &loc, const int) const
+void shader::set_int(std::string_view loc, const int var)
 {
     // set an int uniform
-    glUniform1i(glGetUniformLocation(program, loc.c_str()), 0);
+    set(uniform<int>{find_uniform(loc)}, var);
+}
+
+bool shader::bind_block(std::string_view name, unsigned int binding) const
+{
+    for (const uniform_block_info &block : blocks)
+    {
+        if (block.name == name)
+        {
+            glUniformBlockBinding(program.get(), block.index, binding);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void shader::reflect()
+{
+    int uniform_count{};
+    int max_name_length{};
+
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    std::vector<char> name(max_name_length > 0 ? max_name_length : 1);
+
+    for (int i{}; i < uniform_count; i++)
+    {
+        GLsizei length{};
+        uniform_info info{};
+
+        glGetActiveUniform(program.get(), i, (GLsizei)name.size(), &length, &info.count, &info.type, name.data());
+
+        info.name.assign(name.data(), length);
+
+        // arrays are reported as "name[0]", look them up by their plain name
+        if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0)
+            info.name.resize(info.name.size() - 3);
+
+        info.location = glGetUniformLocation(program.get(), info.name.c_str());
+
+        // members of uniform blocks have no location, they are set through the block's buffer
+        if (info.location < 0)
+            continue;
+
+        uniforms.push_back(info);
+    }
+
+    int block_count{};
+    int max_block_name_length{};
+
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_block_name_length);
+
+    name.resize(max_block_name_length > 0 ? max_block_name_length : 1);
+
+    for (int i{}; i < block_count; i++)
+    {
+        GLsizei length{};
+        uniform_block_info block{};
+
+        glGetActiveUniformBlockName(program.get(), i, (GLsizei)name.size(), &length, name.data());
+        glGetActiveUniformBlockiv(program.get(), i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.size);
+
+        block.name.assign(name.data(), length);
+        block.index = i;
+
+        blocks.push_back(block);
+    }
+}
+
+int shader::find_uniform(std::string_view name) const
+{
+    // programs have a handful of uniforms, a linear scan beats hashing and never allocates
+    for (std::size_t i{}; i < uniforms.size(); i++)
+    {
+        if (uniforms[i].name == name)
+            return (int)i;
+    }
+
+    return -1;
 }
 
 // shader file reading function
@@ -1,4 +1,8 @@
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 #include <iostream>
@@ -8,37 +12,181 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "gl_handle.hpp"
+#include "render_stats.hpp"
+
 #ifndef SHADER_H
 #define SHADER_H
 
+// largest uniform value that gets a shadow copy (a mat4)
+#define UNIFORM_SHADOW_SIZE 64
+
+// programs the render queue's sort key can tell apart, its program field is 8 bits
+#define SHADER_SORT_IDS 256
+
+// an active uniform found by reflection when the program was linked
+struct uniform_info
+{
+    std::string name{};
+    int location{-1};
+    GLenum type{};
+    int count{};
+
+    // last value sent to the program, used to skip redundant glUniform* calls
+    unsigned char shadow[UNIFORM_SHADOW_SIZE]{};
+    bool has_shadow{false};
+};
+
+// an active uniform block found by reflection when the program was linked
+struct uniform_block_info
+{
+    std::string name{};
+    unsigned int index{};
+    int size{};
+};
+
+// a typed handle to a uniform, resolved once by shader::get_uniform
+template <typename T>
+class uniform
+{
+public:
+    uniform() = default;
+
+    bool valid() const {return index >= 0;};
+
+private:
+    friend class shader;
+
+    explicit uniform(int a_index) : index(a_index) {};
+
+    // index into the owning shader's uniform table
+    int index{-1};
+};
+
 class shader
 {
 public:
     // to initalize the shader
     shader(const std::string &vert_path, const std::string &frag_path);
 
-    // to clean up the shader
-    ~shader();
-
     // to call use shader
     void use();
 
+    // to resolve a typed uniform handle, returns an invalid handle if the name or type doesn't match
+    template <typename T>
+    uniform<T> get_uniform(std::string_view name) const;
+
+    // whether the linked program has an active uniform by this name
+    bool has_uniform(std::string_view name) const {return find_uniform(name) >= 0;};
+
+    // to set a uniform through a handle, skipped if the value is unchanged
+    template <typename T>
+    void set(const uniform<T> &handle, const T &var);
+
     // to set mat4 uniforms
-    void set_mat4(const std::string &loc, const glm::mat4 &var) const;
+    void set_mat4(std::string_view loc, const glm::mat4 &var);
 
     // to set vec3 uniforms
-    void set_vec3(const std::string &loc, const glm::vec3 &var) const;
+    void set_vec3(std::string_view loc, const glm::vec3 &var);
 
     // to set int uniforms
-    void set_int(const std::string &loc, const int var) const;
+    void set_int(std::string_view loc, const int var);
+
+    // to bind a uniform block to a binding point, returns false if the program has no such block
+    bool bind_block(std::string_view name, unsigned int binding) const;
+
+    // small id used to group draws by program in render queue sort keys
+    std::uint8_t get_sort_id() const {return sort_id;};
+
+    const std::vector<uniform_info> &get_uniforms() const {return uniforms;};
+    const std::vector<uniform_block_info> &get_blocks() const {return blocks;};
 
 private:
 
-    // shader program id
-    unsigned int program{};
+    // shader program, deleted with the shader
+    program_handle program{};
+
+    // handed out in creation order rather than taken from the program name, which the driver may make as large as it likes
+    std::uint8_t sort_id{};
+
+    // active uniforms and blocks, filled in once after linking
+    std::vector<uniform_info> uniforms;
+    std::vector<uniform_block_info> blocks;
 
     // to read a shader file into a std::string
     std::string readfile(const std::string &filename);
+
+    // to enumerate the active uniforms and uniform blocks of the linked program
+    void reflect();
+
+    // to find a uniform's index in the uniform table, -1 if it isn't active
+    int find_uniform(std::string_view name) const;
+
+    // to map a C++ type to the GL types it may be bound to
+    static bool type_matches(GLenum gl_type, const glm::mat4 *) {return gl_type == GL_FLOAT_MAT4;};
+    static bool type_matches(GLenum gl_type, const glm::mat3 *) {return gl_type == GL_FLOAT_MAT3;};
+    static bool type_matches(GLenum gl_type, const glm::vec4 *) {return gl_type == GL_FLOAT_VEC4;};
+    static bool type_matches(GLenum gl_type, const glm::vec3 *) {return gl_type == GL_FLOAT_VEC3;};
+    static bool type_matches(GLenum gl_type, const glm::vec2 *) {return gl_type == GL_FLOAT_VEC2;};
+    static bool type_matches(GLenum gl_type, const float *) {return gl_type == GL_FLOAT;};
+    static bool type_matches(GLenum gl_type, const int *)
+    {
+        return gl_type == GL_INT || gl_type == GL_BOOL || gl_type == GL_SAMPLER_2D ||
+               gl_type == GL_SAMPLER_3D || gl_type == GL_SAMPLER_CUBE || gl_type == GL_SAMPLER_2D_ARRAY;
+    };
+
+    // to send a value to the currently used program
+    static void upload(int location, const glm::mat4 &var) {glUniformMatrix4fv(location, 1, GL_FALSE, &var[0][0]);};
+    static void upload(int location, const glm::mat3 &var) {glUniformMatrix3fv(location, 1, GL_FALSE, &var[0][0]);};
+    static void upload(int location, const glm::vec4 &var) {glUniform4fv(location, 1, &var[0]);};
+    static void upload(int location, const glm::vec3 &var) {glUniform3fv(location, 1, &var[0]);};
+    static void upload(int location, const glm::vec2 &var) {glUniform2fv(location, 1, &var[0]);};
+    static void upload(int location, const float var) {glUniform1f(location, var);};
+    static void upload(int location, const int var) {glUniform1i(location, var);};
 };
 
-#endif //SHADER_H
\ No newline at end of file
+template <typename T>
+uniform<T> shader::get_uniform(std::string_view name) const
+{
+    int index{find_uniform(name)};
+
+    if (index < 0)
+    {
+        std::cout << "ERROR::SHADER::UNIFORM_NOT_FOUND " << name << std::endl;
+        return uniform<T>{};
+    }
+
+    if (!type_matches(uniforms[index].type, static_cast<const T *>(nullptr)))
+    {
+        std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH " << name << std::endl;
+        return uniform<T>{};
+    }
+
+    return uniform<T>{index};
+}
+
+template <typename T>
+void shader::set(const uniform<T> &handle, const T &var)
+{
+    static_assert(sizeof(T) <= UNIFORM_SHADOW_SIZE, "uniform type too large for its shadow copy");
+
+    if (!handle.valid())
+        return;
+
+    uniform_info &info{uniforms[handle.index]};
+
+    // the program already holds this value
+    if (info.has_shadow && std::memcmp(info.shadow, &var, sizeof(T)) == 0)
+    {
+        g_render_stats.uniform_calls_skipped++;
+        return;
+    }
+
+    std::memcpy(info.shadow, &var, sizeof(T));
+    info.has_shadow = true;
+
+    upload(info.location, var);
+    g_render_stats.uniform_bytes += sizeof(T);
+}
+
+#endif //SHADER_H
@@ -0,0 +1,33 @@
+#include <glm/glm.hpp>
+
+#include "transform.hpp"
+
+glm::mat3 normal_matrix(const glm::mat4 &model)
+{
+    glm::vec3 a{model[0]};
+    glm::vec3 b{model[1]};
+    glm::vec3 c{model[2]};
+
+    // the cofactors of the 3x3 are these cross products, over the determinant they're the inverse transpose
+    glm::vec3 bc{glm::cross(b, c)};
+    float inv_det{1.0f / glm::dot(a, bc)};
+
+    return glm::mat3{bc * inv_det, glm::cross(c, a) * inv_det, glm::cross(a, b) * inv_det};
+}
+
+bool has_uniform_scale(const glm::mat4 &model, float epsilon)
+{
+    float x{glm::dot(glm::vec3(model[0]), glm::vec3(model[0]))};
+    float y{glm::dot(glm::vec3(model[1]), glm::vec3(model[1]))};
+    float z{glm::dot(glm::vec3(model[2]), glm::vec3(model[2]))};
+
+    // shear would also break the shortcut, so the axes must stay perpendicular
+    float xy{glm::dot(glm::vec3(model[0]), glm::vec3(model[1]))};
+    float yz{glm::dot(glm::vec3(model[1]), glm::vec3(model[2]))};
+    float zx{glm::dot(glm::vec3(model[2]), glm::vec3(model[0]))};
+
+    float tolerance{epsilon * x};
+
+    return glm::abs(x - y) <= tolerance && glm::abs(x - z) <= tolerance &&
+           glm::abs(xy) <= tolerance && glm::abs(yz) <= tolerance && glm::abs(zx) <= tolerance;
+}
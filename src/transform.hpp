@@ -0,0 +1,12 @@
+#include <glm/glm.hpp>
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+// to compute the matrix that transforms normals, the inverse transpose of the model's upper 3x3
+glm::mat3 normal_matrix(const glm::mat4 &model);
+
+// to check whether a model scales every axis equally, so its upper 3x3 already transforms normals
+bool has_uniform_scale(const glm::mat4 &model, float epsilon = 1e-4f);
+
+#endif //TRANSFORM_H
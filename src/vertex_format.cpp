@@ -0,0 +1,106 @@
+#include <cstring>
+
+#include "vertex_format.hpp"
+#include "vertex_packing.hpp"
+
+// bytes an element's values take, before padding
+static std::size_t element_size(const vertex_element &element)
+{
+    switch (element.type)
+    {
+    case attribute_type::half_float:
+        return element.components * sizeof(std::uint16_t);
+    case attribute_type::snorm_2_10_10_10:
+        return sizeof(std::uint32_t);
+    case attribute_type::unorm8:
+        return element.components * sizeof(std::uint8_t);
+    case attribute_type::float32:
+    default:
+        return element.components * sizeof(float);
+    }
+}
+
+vertex_format &vertex_format::add(unsigned int location, int components, attribute_type type, std::size_t source_offset)
+{
+    vertex_element element{location, components, type, source_offset, stride};
+
+    elements.push_back(element);
+
+    // keep the next element and the whole vertex 4 byte aligned
+    stride += (element_size(element) + 3) & ~std::size_t{3};
+
+    return *this;
+}
+
+void vertex_format::apply(unsigned int divisor) const
+{
+    for (const vertex_element &element : elements)
+    {
+        glEnableVertexAttribArray(element.location);
+
+        switch (element.type)
+        {
+        case attribute_type::half_float:
+            glVertexAttribPointer(element.location, element.components, GL_HALF_FLOAT, GL_FALSE, (GLsizei)stride, (void *)element.offset);
+            break;
+        case attribute_type::snorm_2_10_10_10:
+            glVertexAttribPointer(element.location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, (GLsizei)stride, (void *)element.offset);
+            break;
+        case attribute_type::unorm8:
+            glVertexAttribPointer(element.location, element.components, GL_UNSIGNED_BYTE, GL_TRUE, (GLsizei)stride, (void *)element.offset);
+            break;
+        case attribute_type::float32:
+        default:
+            glVertexAttribPointer(element.location, element.components, GL_FLOAT, GL_FALSE, (GLsizei)stride, (void *)element.offset);
+            break;
+        }
+
+        glVertexAttribDivisor(element.location, divisor);
+    }
+}
+
+void vertex_format::encode(const float *source, std::size_t vertex_count, std::size_t source_stride, std::vector<std::uint8_t> &out) const
+{
+    out.resize(vertex_count * stride);
+
+    // each element is gathered into a contiguous float array, converted in bulk, then interleaved
+    for (const vertex_element &element : elements)
+    {
+        // 2_10_10_10 always converts xyzw, missing components become 0
+        std::size_t gathered_components{element.type == attribute_type::snorm_2_10_10_10 ? 4 : (std::size_t)element.components};
+
+        gathered.assign(vertex_count * gathered_components, 0.0f);
+
+        for (std::size_t v{}; v < vertex_count; v++)
+        {
+            const float *src{source + v * source_stride + element.source_offset};
+            float *dst{gathered.data() + v * gathered_components};
+
+            for (int c{}; c < element.components && c < (int)gathered_components; c++)
+                dst[c] = src[c];
+        }
+
+        std::size_t size{element_size(element)};
+        packed.resize(vertex_count * size);
+
+        switch (element.type)
+        {
+        case attribute_type::half_float:
+            encode_half(gathered.data(), (std::uint16_t *)packed.data(), gathered.size());
+            break;
+        case attribute_type::snorm_2_10_10_10:
+            encode_snorm_2_10_10_10(gathered.data(), (std::uint32_t *)packed.data(), vertex_count);
+            break;
+        case attribute_type::unorm8:
+            encode_unorm8(gathered.data(), packed.data(), gathered.size());
+            break;
+        case attribute_type::float32:
+        default:
+            std::memcpy(packed.data(), gathered.data(), packed.size());
+            break;
+        }
+
+        for (std::size_t v{}; v < vertex_count; v++)
+            std::memcpy(out.data() + v * stride + element.offset, packed.data() + v * size, size);
+    }
+}
@@ -0,0 +1,68 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+// how an attribute is stored in the vertex buffer, the shader always sees floats
+enum class attribute_type : std::uint8_t
+{
+    // 4 bytes per component
+    float32,
+
+    // 2 bytes per component
+    half_float,
+
+    // 4 bytes for xyz plus a 2-bit w, components in [-1, 1], for normals
+    snorm_2_10_10_10,
+
+    // 1 byte per component, components in [0, 1], for colors
+    unorm8
+};
+
+// one attribute of an interleaved vertex, read from float source data
+struct vertex_element
+{
+    unsigned int location{};
+    int components{};
+    attribute_type type{};
+
+    // float offset of the attribute in a source vertex
+    std::size_t source_offset{};
+
+    // byte offset of the attribute in an encoded vertex, filled in by vertex_format::add
+    std::size_t offset{};
+};
+
+// layout of an interleaved vertex buffer, every element starts 4 byte aligned
+class vertex_format
+{
+public:
+    // to append an element, read from source_offset floats into each source vertex
+    vertex_format &add(unsigned int location, int components, attribute_type type, std::size_t source_offset);
+
+    // to point the bound vertex array's attributes at the bound array buffer, divisor 1 for instance data
+    void apply(unsigned int divisor = 0) const;
+
+    // to encode vertex_count float source vertices of source_stride floats into this format
+    void encode(const float *source, std::size_t vertex_count, std::size_t source_stride, std::vector<std::uint8_t> &out) const;
+
+    // to free the encode scratch buffers, for formats that won't encode again
+    void release_scratch() const {gathered = {}; packed = {};};
+
+    std::size_t get_stride() const {return stride;};
+    const std::vector<vertex_element> &get_elements() const {return elements;};
+
+private:
+    std::vector<vertex_element> elements{};
+    std::size_t stride{};
+
+    // reused between encodes so re-encoding instance data doesn't reallocate
+    mutable std::vector<float> gathered{};
+    mutable std::vector<std::uint8_t> packed{};
+};
+
+#endif //VERTEX_FORMAT_H
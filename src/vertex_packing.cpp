@@ -0,0 +1,112 @@
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "vertex_packing.hpp"
+
+// F16C isn't part of the x86-64 baseline, it is compiled in and picked at runtime
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define VERTEX_PACKING_F16C 1
+
+__attribute__((target("f16c")))
+static void encode_half_f16c(const float *src, std::uint16_t *dst, std::size_t count)
+{
+    std::size_t i{};
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low{_mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT)};
+        __m128i high{_mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT)};
+
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi64(low, high));
+    }
+
+    for (; i < count; i++)
+        dst[i] = glm::packHalf1x16(src[i]);
+}
+#endif
+
+void encode_half(const float *src, std::uint16_t *dst, std::size_t count)
+{
+#if defined(VERTEX_PACKING_F16C)
+    static const bool has_f16c{__builtin_cpu_supports("f16c") != 0};
+
+    if (has_f16c)
+        return encode_half_f16c(src, dst, count);
+#endif
+
+    std::size_t i{};
+
+#if defined(__aarch64__)
+    for (; i + 4 <= count; i += 4)
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+#endif
+
+    for (; i < count; i++)
+        dst[i] = glm::packHalf1x16(src[i]);
+}
+
+void encode_unorm8(const float *src, std::uint8_t *dst, std::size_t count)
+{
+    std::size_t i{};
+
+#if defined(__SSE2__)
+    __m128 zero{_mm_setzero_ps()};
+    __m128 one{_mm_set1_ps(1.0f)};
+    __m128 scale{_mm_set1_ps(255.0f)};
+
+    // 16 floats become 16 bytes, converting with saturating packs
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i packed[4];
+
+        for (int j{}; j < 4; j++)
+        {
+            __m128 v{_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), zero), one)};
+            packed[j] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+        }
+
+        __m128i words{_mm_packs_epi32(packed[0], packed[1])};
+        __m128i words_high{_mm_packs_epi32(packed[2], packed[3])};
+
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(words, words_high));
+    }
+#endif
+
+    for (; i < count; i++)
+        dst[i] = glm::packUnorm1x8(src[i]);
+}
+
+void encode_snorm_2_10_10_10(const float *xyzw, std::uint32_t *dst, std::size_t count)
+{
+    std::size_t i{};
+
+#if defined(__SSE2__)
+    __m128 low{_mm_setr_ps(-1.0f, -1.0f, -1.0f, -1.0f)};
+    __m128 high{_mm_set1_ps(1.0f)};
+    __m128 scale{_mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f)};
+    __m128i mask{_mm_setr_epi32(0x3FF, 0x3FF, 0x3FF, 0x3)};
+
+    for (; i < count; i++)
+    {
+        __m128 v{_mm_min_ps(_mm_max_ps(_mm_loadu_ps(xyzw + i * 4), low), high)};
+        __m128i q{_mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(v, scale)), mask)};
+
+        // two's complement fields, already masked to their width
+        alignas(16) std::uint32_t fields[4];
+        _mm_store_si128((__m128i *)fields, q);
+
+        dst[i] = fields[0] | (fields[1] << 10) | (fields[2] << 20) | (fields[3] << 30);
+    }
+#endif
+
+    for (; i < count; i++)
+        dst[i] = glm::packSnorm3x10_1x2(glm::vec4(xyzw[i * 4], xyzw[i * 4 + 1], xyzw[i * 4 + 2], xyzw[i * 4 + 3]));
+}
@@ -0,0 +1,19 @@
+#include <cstddef>
+#include <cstdint>
+
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+// bulk float to packed attribute converters, vectorized where the cpu allows and
+// matching glm/gtc/packing.hpp otherwise (up to rounding of exact halves)
+
+// to convert count floats to IEEE half floats
+void encode_half(const float *src, std::uint16_t *dst, std::size_t count);
+
+// to convert count floats in [0, 1] to normalized unsigned bytes
+void encode_unorm8(const float *src, std::uint8_t *dst, std::size_t count);
+
+// to convert count xyzw vectors in [-1, 1] to GL_INT_2_10_10_10_REV, x in the low bits
+void encode_snorm_2_10_10_10(const float *xyzw, std::uint32_t *dst, std::size_t count);
+
+#endif //VERTEX_PACKING_H
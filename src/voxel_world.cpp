@@ -0,0 +1,333 @@
+#include "voxel_world.hpp"
+
+void voxel_chunk::fill(block_id block)
+{
+    palette.assign(1, block);
+    counts.assign(1, VOXEL_CHUNK_VOLUME);
+    free_entries.clear();
+    lookup.clear();
+
+    // a uniform chunk keeps nothing per block
+    words.clear();
+    words.shrink_to_fit();
+
+    bits = 0;
+    bits_log2 = 0;
+    per_word_log2 = 6;
+    per_word = 64;
+    mask = 0;
+}
+
+block_id voxel_chunk::set(int x, int y, int z, block_id block)
+{
+    std::uint32_t index{index_of(x, y, z)};
+    std::uint32_t old_entry{bits ? read(index) : 0};
+    block_id old{palette[old_entry]};
+
+    if (old == block)
+        return old;
+
+    std::uint32_t entry{find_or_add(block)};
+    write(index, entry);
+
+    counts[entry]++;
+    if (--counts[old_entry] == 0)
+        release(old_entry);
+
+    // the last block of every other type was just replaced
+    if (counts[entry] == VOXEL_CHUNK_VOLUME)
+        fill(block);
+
+    return old;
+}
+
+std::uint32_t voxel_chunk::find_or_add(block_id block)
+{
+    if (lookup.empty())
+    {
+        for (std::uint32_t entry{}; entry < palette.size(); entry++)
+        {
+            if (counts[entry] && palette[entry] == block)
+                return entry;
+        }
+    }
+    else
+    {
+        auto found{lookup.find(block)};
+        if (found != lookup.end())
+            return found->second;
+    }
+
+    std::uint32_t entry{};
+
+    if (!free_entries.empty())
+    {
+        entry = free_entries.back();
+        free_entries.pop_back();
+        palette[entry] = block;
+    }
+    else
+    {
+        entry = (std::uint32_t)palette.size();
+        palette.push_back(block);
+        counts.push_back(0);
+
+        // a uniform chunk becomes 1 bit wide, a full palette doubles its width
+        if (bits == 0)
+            repack(0);
+        else if (palette.size() > (std::size_t)mask + 1)
+            repack(bits_log2 + 1);
+    }
+
+    if (!lookup.empty())
+        lookup.emplace(block, entry);
+    else if (palette.size() > VOXEL_PALETTE_SCAN)
+    {
+        for (std::uint32_t live{}; live < palette.size(); live++)
+        {
+            if (counts[live] || live == entry)
+                lookup.emplace(palette[live], live);
+        }
+    }
+
+    return entry;
+}
+
+void voxel_chunk::release(std::uint32_t entry)
+{
+    free_entries.push_back(entry);
+
+    if (!lookup.empty())
+        lookup.erase(palette[entry]);
+}
+
+void voxel_chunk::repack(int new_bits_log2, const std::vector<std::uint32_t> *remap)
+{
+    int new_bits{1 << new_bits_log2};
+    std::uint32_t new_per_word_log2{(std::uint32_t)(6 - new_bits_log2)};
+
+    std::vector<std::uint64_t> packed(VOXEL_CHUNK_VOLUME >> new_per_word_log2, 0);
+
+    for (std::uint32_t index{}; index < VOXEL_CHUNK_VOLUME; index++)
+    {
+        std::uint64_t entry{bits ? read(index) : 0};
+        if (remap)
+            entry = (*remap)[entry];
+
+        std::uint32_t shift{(index & ((1u << new_per_word_log2) - 1)) << new_bits_log2};
+        packed[index >> new_per_word_log2] |= entry << shift;
+    }
+
+    words = std::move(packed);
+
+    bits = new_bits;
+    bits_log2 = new_bits_log2;
+    per_word_log2 = new_per_word_log2;
+    per_word = 1u << new_per_word_log2;
+    mask = (1u << new_bits) - 1;
+}
+
+void voxel_chunk::compact()
+{
+    if (bits == 0 || free_entries.empty())
+        return;
+
+    std::size_t live_count{get_palette_size()};
+
+    if (live_count == 1)
+    {
+        for (std::uint32_t entry{}; entry < palette.size(); entry++)
+        {
+            if (counts[entry])
+            {
+                fill(palette[entry]);
+                return;
+            }
+        }
+    }
+
+    // live entries keep their order, freed ones are dropped
+    std::vector<std::uint32_t> remap(palette.size(), 0);
+    std::vector<block_id> live_palette{};
+    std::vector<std::uint32_t> live_counts{};
+
+    for (std::uint32_t entry{}; entry < palette.size(); entry++)
+    {
+        if (!counts[entry])
+            continue;
+
+        remap[entry] = (std::uint32_t)live_palette.size();
+        live_palette.push_back(palette[entry]);
+        live_counts.push_back(counts[entry]);
+    }
+
+    int new_bits_log2{0};
+    while ((std::size_t)1 << (1 << new_bits_log2) < live_count)
+        new_bits_log2++;
+
+    repack(new_bits_log2, &remap);
+
+    palette = std::move(live_palette);
+    counts = std::move(live_counts);
+    free_entries.clear();
+
+    lookup.clear();
+    if (palette.size() > VOXEL_PALETTE_SCAN)
+    {
+        for (std::uint32_t entry{}; entry < palette.size(); entry++)
+            lookup.emplace(palette[entry], entry);
+    }
+}
+
+std::uint32_t voxel_chunk::get_solid_count() const
+{
+    std::uint32_t solid{0};
+
+    for (std::uint32_t entry{}; entry < palette.size(); entry++)
+    {
+        if (palette[entry] != VOXEL_AIR)
+            solid += counts[entry];
+    }
+
+    return solid;
+}
+
+std::size_t voxel_chunk::get_memory_usage() const
+{
+    // a hash map node holds the pair and a next pointer, every bucket a pointer
+    std::size_t lookup_bytes{lookup.size() * (sizeof(std::pair<block_id, std::uint32_t>) + sizeof(void *)) + lookup.bucket_count() * sizeof(void *)};
+
+    return sizeof(*this) + palette.capacity() * sizeof(block_id) + counts.capacity() * sizeof(std::uint32_t) +
+           free_entries.capacity() * sizeof(std::uint32_t) + words.capacity() * sizeof(std::uint64_t) + lookup_bytes;
+}
+
+std::uint64_t voxel_world::key_of(const glm::ivec3 &chunk_pos)
+{
+    return ((std::uint64_t)(chunk_pos.x & 0x1FFFFF) << 42) | ((std::uint64_t)(chunk_pos.y & 0x1FFFFF) << 21) | (std::uint64_t)(chunk_pos.z & 0x1FFFFF);
+}
+
+glm::ivec3 voxel_world::chunk_of_key(std::uint64_t key)
+{
+    // to move each field to the top and shift it back down, sign extending it
+    auto field = [key](int shift) {return (int)((std::int64_t)(key << (43 - shift)) >> 43);};
+
+    return glm::ivec3(field(42), field(21), field(0));
+}
+
+block_id voxel_world::get(const glm::ivec3 &pos) const
+{
+    const voxel_chunk *chunk{find_chunk(chunk_of(pos))};
+    if (!chunk)
+        return VOXEL_AIR;
+
+    glm::ivec3 local{local_of(pos)};
+    return chunk->get(local.x, local.y, local.z);
+}
+
+void voxel_world::set(const glm::ivec3 &pos, block_id block)
+{
+    std::uint64_t key{key_of(chunk_of(pos))};
+    auto found{chunks.find(key)};
+
+    if (found == chunks.end())
+    {
+        // air over a missing chunk changes nothing
+        if (block == VOXEL_AIR)
+            return;
+
+        found = chunks.emplace(key, voxel_chunk{}).first;
+    }
+
+    glm::ivec3 local{local_of(pos)};
+    found->second.set(local.x, local.y, local.z, block);
+
+    if (found->second.is_empty())
+        chunks.erase(found);
+}
+
+void voxel_world::fill(const glm::ivec3 &min, const glm::ivec3 &max, block_id block)
+{
+    if (glm::any(glm::greaterThanEqual(min, max)))
+        return;
+
+    glm::ivec3 first{chunk_of(min)};
+    glm::ivec3 last{chunk_of(max - 1)};
+
+    for (int cy{first.y}; cy <= last.y; cy++)
+    for (int cz{first.z}; cz <= last.z; cz++)
+    for (int cx{first.x}; cx <= last.x; cx++)
+    {
+        glm::ivec3 chunk_pos{cx, cy, cz};
+        glm::ivec3 origin{chunk_pos * VOXEL_CHUNK_SIZE};
+
+        glm::ivec3 box_min{glm::max(min, origin)};
+        glm::ivec3 box_max{glm::min(max, origin + VOXEL_CHUNK_SIZE)};
+
+        std::uint64_t key{key_of(chunk_pos)};
+
+        // a chunk the box covers whole becomes uniform without touching its blocks
+        if (box_min == origin && box_max == origin + VOXEL_CHUNK_SIZE)
+        {
+            if (block == VOXEL_AIR)
+                chunks.erase(key);
+            else
+                chunks.insert_or_assign(key, voxel_chunk{block});
+
+            continue;
+        }
+
+        auto found{chunks.find(key)};
+
+        if (found == chunks.end())
+        {
+            if (block == VOXEL_AIR)
+                continue;
+
+            found = chunks.emplace(key, voxel_chunk{}).first;
+        }
+
+        voxel_chunk &chunk{found->second};
+        box_min -= origin;
+        box_max -= origin;
+
+        for (int y{box_min.y}; y < box_max.y; y++)
+        for (int z{box_min.z}; z < box_max.z; z++)
+        for (int x{box_min.x}; x < box_max.x; x++)
+            chunk.set(x, y, z, block);
+
+        if (chunk.is_empty())
+            chunks.erase(found);
+    }
+}
+
+void voxel_world::compact()
+{
+    for (auto &[key, chunk] : chunks)
+        chunk.compact();
+}
+
+const voxel_chunk *voxel_world::find_chunk(const glm::ivec3 &chunk_pos) const
+{
+    auto found{chunks.find(key_of(chunk_pos))};
+    return found == chunks.end() ? nullptr : &found->second;
+}
+
+std::uint64_t voxel_world::get_solid_count() const
+{
+    std::uint64_t solid{0};
+    for (const auto &[key, chunk] : chunks)
+        solid += chunk.get_solid_count();
+
+    return solid;
+}
+
+std::size_t voxel_world::get_memory_usage() const
+{
+    // a chunk table node holds the key, the chunk and a next pointer, every bucket a pointer
+    std::size_t bytes{sizeof(*this) + chunks.bucket_count() * sizeof(void *)};
+
+    for (const auto &[key, chunk] : chunks)
+        bytes += chunk.get_memory_usage() + sizeof(key) + sizeof(void *);
+
+    return bytes;
+}
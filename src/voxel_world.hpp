@@ -0,0 +1,214 @@
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#ifndef VOXEL_WORLD_H
+#define VOXEL_WORLD_H
+
+// chunks are 32 blocks on a side
+#define VOXEL_CHUNK_BITS 5
+#define VOXEL_CHUNK_SIZE (1 << VOXEL_CHUNK_BITS)
+#define VOXEL_CHUNK_VOLUME (VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE * VOXEL_CHUNK_SIZE)
+
+// the empty block, chunks that only hold it aren't stored at all
+#define VOXEL_AIR 0
+
+// palettes up to this size are searched linearly, bigger ones get a hash map
+#define VOXEL_PALETTE_SCAN 16
+
+// a block type, what it looks like is up to whoever draws the world
+using block_id = std::uint16_t;
+
+// a 32^3 block of the world. blocks are stored as indices into a palette of the block types the
+// chunk holds, packed 1, 2, 4, 8 or 16 bits wide so an index never straddles two words.
+// a chunk holding one block type keeps no indices at all, air or otherwise.
+// palette entries are reference counted, an entry no block uses any more is reused by the next new type,
+// and the index width only shrinks back in compact
+class voxel_chunk
+{
+public:
+    explicit voxel_chunk(block_id block = VOXEL_AIR) {fill(block);};
+
+    // coordinates are local, 0 to VOXEL_CHUNK_SIZE - 1
+    block_id get(int x, int y, int z) const {return bits ? palette[read(index_of(x, y, z))] : palette[0];};
+
+    // to change a block, returns the block it replaced
+    block_id set(int x, int y, int z, block_id block);
+
+    // to make every block the same, dropping the indices
+    void fill(block_id block);
+
+    // to drop unused palette entries and narrow the indices to what's left
+    void compact();
+
+    // to visit(x, y, z, block) every block that isn't air, in storage order
+    template <class F>
+    void for_each(F &&visit) const;
+
+    bool is_uniform() const {return bits == 0;};
+    bool is_empty() const {return bits == 0 && palette[0] == VOXEL_AIR;};
+
+    // blocks that aren't air
+    std::uint32_t get_solid_count() const;
+
+    // bits per block, 0 for a uniform chunk
+    int get_bits() const {return bits;};
+
+    // block types the chunk holds
+    std::size_t get_palette_size() const {return palette.size() - free_entries.size();};
+
+    // heap and object bytes the chunk holds
+    std::size_t get_memory_usage() const;
+
+    // y major, so a horizontal slice is contiguous
+    static std::uint32_t index_of(int x, int y, int z) {return ((std::uint32_t)y << (2 * VOXEL_CHUNK_BITS)) | ((std::uint32_t)z << VOXEL_CHUNK_BITS) | (std::uint32_t)x;};
+
+private:
+    std::uint32_t read(std::uint32_t index) const
+    {
+        std::uint32_t shift{(index & (per_word - 1)) << bits_log2};
+        return (std::uint32_t)(words[index >> per_word_log2] >> shift) & mask;
+    };
+
+    void write(std::uint32_t index, std::uint32_t entry)
+    {
+        std::uint32_t shift{(index & (per_word - 1)) << bits_log2};
+        std::uint64_t &word{words[index >> per_word_log2]};
+        word = (word & ~((std::uint64_t)mask << shift)) | ((std::uint64_t)entry << shift);
+    };
+
+    // to get the block's palette entry, adding it and widening the indices if it's new
+    std::uint32_t find_or_add(block_id block);
+
+    // to stop counting an entry once no block uses it
+    void release(std::uint32_t entry);
+
+    // to repack every index at 1 << new_bits_log2 bits, through remap if given
+    void repack(int new_bits_log2, const std::vector<std::uint32_t> *remap = nullptr);
+
+    std::vector<block_id> palette{};
+
+    // blocks using each palette entry
+    std::vector<std::uint32_t> counts{};
+
+    // entries no block uses any more
+    std::vector<std::uint32_t> free_entries{};
+
+    // block to entry, only filled once the palette outgrows VOXEL_PALETTE_SCAN
+    std::unordered_map<block_id, std::uint32_t> lookup{};
+
+    std::vector<std::uint64_t> words{};
+
+    int bits{0};
+    int bits_log2{0};
+    std::uint32_t per_word_log2{6};
+    std::uint32_t per_word{64};
+    std::uint32_t mask{0};
+};
+
+// the world as sparse 32^3 chunks, chunks that are all air aren't stored.
+// block positions are integers, chunk positions are block positions shifted down by VOXEL_CHUNK_BITS
+class voxel_world
+{
+public:
+    block_id get(const glm::ivec3 &pos) const;
+
+    // to change a block, a chunk that ends up all air is freed
+    void set(const glm::ivec3 &pos, block_id block);
+
+    // to set every block from min up to but not including max, chunks the box covers are filled whole
+    void fill(const glm::ivec3 &min, const glm::ivec3 &max, block_id block);
+
+    // to compact every chunk's palette and indices, after a batch of edits
+    void compact();
+
+    void clear() {chunks.clear();};
+
+    // to visit(pos, block) every block that isn't air, chunk by chunk
+    template <class F>
+    void for_each(F &&visit) const;
+
+    // the chunk at a chunk position, null if it's all air
+    const voxel_chunk *find_chunk(const glm::ivec3 &chunk_pos) const;
+
+    std::size_t get_chunk_count() const {return chunks.size();};
+
+    // blocks that aren't air
+    std::uint64_t get_solid_count() const;
+
+    // bytes the chunks and the chunk table hold
+    std::size_t get_memory_usage() const;
+
+    // arithmetic shifts, so negative positions round down to their chunk
+    static glm::ivec3 chunk_of(const glm::ivec3 &pos) {return glm::ivec3(pos.x >> VOXEL_CHUNK_BITS, pos.y >> VOXEL_CHUNK_BITS, pos.z >> VOXEL_CHUNK_BITS);};
+    static glm::ivec3 local_of(const glm::ivec3 &pos) {return pos & (VOXEL_CHUNK_SIZE - 1);};
+
+private:
+    // 21 bits per axis, chunk positions within a million of the origin
+    static std::uint64_t key_of(const glm::ivec3 &chunk_pos);
+    static glm::ivec3 chunk_of_key(std::uint64_t key);
+
+    std::unordered_map<std::uint64_t, voxel_chunk> chunks{};
+};
+
+template <class F>
+void voxel_chunk::for_each(F &&visit) const
+{
+    if (bits == 0)
+    {
+        if (palette[0] == VOXEL_AIR)
+            return;
+
+        for (std::uint32_t index{}; index < VOXEL_CHUNK_VOLUME; index++)
+            visit((int)(index & (VOXEL_CHUNK_SIZE - 1)), (int)(index >> (2 * VOXEL_CHUNK_BITS)), (int)((index >> VOXEL_CHUNK_BITS) & (VOXEL_CHUNK_SIZE - 1)), palette[0]);
+
+        return;
+    }
+
+    // a word of nothing but air is skipped without decoding it
+    bool has_air{false};
+    std::uint64_t air_word{};
+    for (std::uint32_t entry{}; entry < palette.size(); entry++)
+    {
+        if (counts[entry] && palette[entry] == VOXEL_AIR)
+        {
+            has_air = true;
+            air_word = entry;
+            for (int shift{bits}; shift < 64; shift *= 2)
+                air_word |= air_word << shift;
+        }
+    }
+
+    for (std::uint32_t word_index{}; word_index < words.size(); word_index++)
+    {
+        std::uint64_t word{words[word_index]};
+        if (has_air && word == air_word)
+            continue;
+
+        std::uint32_t index{word_index << per_word_log2};
+
+        for (std::uint32_t i{}; i < per_word; i++, index++, word >>= bits)
+        {
+            block_id block{palette[(std::uint32_t)word & mask]};
+
+            if (block != VOXEL_AIR)
+                visit((int)(index & (VOXEL_CHUNK_SIZE - 1)), (int)(index >> (2 * VOXEL_CHUNK_BITS)), (int)((index >> VOXEL_CHUNK_BITS) & (VOXEL_CHUNK_SIZE - 1)), block);
+        }
+    }
+}
+
+template <class F>
+void voxel_world::for_each(F &&visit) const
+{
+    for (const auto &[key, chunk] : chunks)
+    {
+        glm::ivec3 origin{chunk_of_key(key) * VOXEL_CHUNK_SIZE};
+
+        chunk.for_each([&](int x, int y, int z, block_id block) {visit(origin + glm::ivec3(x, y, z), block);});
+    }
+}
+
+#endif //VOXEL_WORLD_H
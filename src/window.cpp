@@ -0,0 +1,81 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "window.hpp"
+#include "gl_trace.hpp"
+
+// to create the window, retrying on other context apis when headless
+static GLFWwindow *create_window(int width, int height, bool headless)
+{
+    glfwWindowHint(GLFW_VISIBLE, headless ? GLFW_FALSE : GLFW_TRUE);
+
+    GLFWwindow *window = glfwCreateWindow(width, height, "", NULL, NULL);
+    if (window != NULL || !headless)
+        return window;
+
+    // the default context api isn't available everywhere, try EGL surfaceless then OSMesa (llvmpipe)
+    std::cout << "retrying with an EGL context..." << std::endl;
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    window = glfwCreateWindow(width, height, "", NULL, NULL);
+    if (window != NULL)
+        return window;
+
+    std::cout << "retrying with an OSMesa context..." << std::endl;
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    return glfwCreateWindow(width, height, "", NULL, NULL);
+}
+
+GLFWwindow *open_window(int width, int height, bool headless)
+{
+    // without a display server, use GLFW's null platform so the context comes from EGL or OSMesa
+    if (headless && !std::getenv("DISPLAY") && !std::getenv("WAYLAND_DISPLAY"))
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+    // GLFW initialization
+    std::cout << "initializing GLFW..." << std::endl;
+    if (!glfwInit())
+    {
+        std::cout << "GLFW initialization failed!" << std::endl;
+        return NULL;
+    }
+    std::cout << "GLFW initialized!" << std::endl;
+
+    // GLFW window hints
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
+#endif
+    std::cout << "window hints passed!" << std::endl;
+
+    // creating a window
+    std::cout << "creating a GLFW window..." << std::endl;
+    GLFWwindow *window = create_window(width, height, headless);
+    if (window == NULL)
+    {
+        std::cout << "failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return NULL;
+    }
+    std::cout << "GLFW window created!" << std::endl;
+    glfwMakeContextCurrent(window);
+
+    // GLAD initialization (loading openGL function pointers)
+    std::cout << "initializing GLAD..." << std::endl;
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "GLAD initialization failed!" << std::endl;
+        glfwTerminate();
+        return NULL;
+    }
+    std::cout << "GLAD initialized" << std::endl;
+
+    // wraps every GL call when built with OXIDIZER_GL_TRACE
+    if (gl_trace::get().install())
+        std::cout << "GL calls are traced" << std::endl;
+
+    return window;
+}
@@ -0,0 +1,12 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+// to initialize GLFW, open a window on a 3.3 core context and load GL through GLAD.
+// headless windows are hidden and, without a display server, use GLFW's null platform
+// with an EGL or OSMesa context. returns NULL, with GLFW terminated, on failure
+GLFWwindow *open_window(int width, int height, bool headless);
+
+#endif //WINDOW_H